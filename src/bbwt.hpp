@@ -0,0 +1,232 @@
+#ifndef BBWT_HPP
+#define BBWT_HPP
+
+// Bijective Burrows-Wheeler transform, described in:
+// "Bijective BWT based Compression Schemes" (arXiv:2406.16475)
+// the last symbols of the conjugates of the Lyndon factors of the input, sorted in omega-order.
+// Unlike the BWT, no sentinel and no primary index are needed to invert it.
+
+#include <atomic>
+#include <ostream>
+#include "duval.hpp"
+#include "conjugates.hpp"
+#include "bwt.hpp"
+#include "optimalSuffixArray.hpp"
+#include "parallel.hpp"
+using namespace std;
+
+// SA gets the conjugates of the Lyndon factors of input in omega-order, as positions in input.
+// Returns the starting positions of the factors, followed by length
+template<typename CharT, typename IndexT>
+vector<IndexT> bbwtOrder(const CharT *const input, IndexT *const SA, const IndexT length)
+{
+    vector<IndexT> factors = duvalBoundaries(input, length);
+    sortConjugates(input, factors.data(), static_cast<IndexT>(factors.size() - 1), SA, length);
+    return factors;
+}
+
+// chars are compared as unsigned bytes, as in the sort and in the LF table of unbbwt: with signed chars the
+// factors would not be Lyndon words in the order of the sort
+template<typename IndexT>
+vector<IndexT> bbwtOrder(const char *const input, IndexT *const SA, const IndexT length)
+{
+    return bbwtOrder(reinterpret_cast<const uint8_t *>(input), SA, length);
+}
+
+// SA is used as workspace
+template<typename CharT, typename IndexT>
+void bbwt(const CharT *const input, IndexT *const SA, const IndexT length, CharT *const output)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    const vector<IndexT> factors = bbwtOrder(input, SA, length);
+    const CyclicWords<IndexT> cycles(factors.data(), static_cast<IndexT>(factors.size() - 1), length);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        output[i] = input[cycles.prev(SA[i])];
+    }
+}
+
+// same as bbwt, but the symbols are written to a binary stream
+template<typename CharT, typename IndexT>
+void writeBBWT(const CharT *const input, IndexT *const SA, const IndexT length, ostream &out, const unsigned long bytes_per_char = sizeof(CharT))
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    const vector<IndexT> factors = bbwtOrder(input, SA, length);
+    const CyclicWords<IndexT> cycles(factors.data(), static_cast<IndexT>(factors.size() - 1), length);
+    SymbolWriter<CharT> writer(out, bytes_per_char);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        writer.put(input[cycles.prev(SA[i])]);
+    }
+}
+
+// row i of the LF table: the i-th symbol of the transform next to the row of the conjugate rotated right by one,
+// so that following a cycle reads a single array
+template<typename CharT, typename IndexT>
+struct LFEntry
+{
+    IndexT lf;
+    CharT symbol;
+};
+
+// LF[i] = number of symbols smaller than input[i] + occurrences of input[i] before i
+// the counts of each thread's chunk are computed independently and then combined
+template<typename CharT, typename IndexT>
+vector<LFEntry<CharT, IndexT>> lfTable(const CharT *const input, const IndexT length, const unsigned threads = 1)
+{
+    vector<LFEntry<CharT, IndexT>> table(length);
+    withSmallSymbols(input, length, [&](const auto &sym, const IndexT upper)
+    {
+        const unsigned long chunks = max(1UL, min<unsigned long>(threads, length));
+        vector<vector<IndexT>> counts(chunks, vector<IndexT>(upper + 1, 0));
+        parallelFor(0, chunks, chunks, [&](const unsigned long first, const unsigned long last)
+        {
+            for (unsigned long chunk = first; chunk < last; ++chunk)
+            {
+                for (IndexT i = length * chunk / chunks; i < length * (chunk + 1) / chunks; ++i)
+                {
+                    ++counts[chunk][sym(i)];
+                }
+            }
+        });
+
+        // counts[chunk][c] becomes the first LF value of symbol c in the chunk
+        IndexT sum = 0;
+        for (IndexT c = 0; c <= upper; ++c)
+        {
+            for (unsigned long chunk = 0; chunk < chunks; ++chunk)
+            {
+                const IndexT count = counts[chunk][c];
+                counts[chunk][c] = sum;
+                sum += count;
+            }
+        }
+
+        parallelFor(0, chunks, chunks, [&](const unsigned long first, const unsigned long last)
+        {
+            for (unsigned long chunk = first; chunk < last; ++chunk)
+            {
+                for (IndexT i = length * chunk / chunks; i < length * (chunk + 1) / chunks; ++i)
+                {
+                    table[i].lf = counts[chunk][sym(i)]++;
+                    table[i].symbol = input[i];
+                }
+            }
+        });
+    });
+    return table;
+}
+
+// inverse of bbwt. Each cycle of LF is a Lyndon factor (repeated factors give one cycle each), its smallest row
+// holds the factor itself, and the factors appear in increasing order: the text is rebuilt from its end,
+// reading each factor backwards. Visited rows are marked with the MSB of their LF value
+template<typename CharT, typename IndexT>
+void unbbwt(const CharT *const input, const IndexT length, CharT *const output)
+{
+    vector<LFEntry<CharT, IndexT>> table = lfTable(input, length);
+    IndexT position = length;
+    for (IndexT row = 0; row < length; ++row)
+    {
+        if (table[row].lf & MSB<IndexT>)
+        {
+            continue;
+        }
+        IndexT j = row;
+        do
+        {
+            output[--position] = table[j].symbol;
+            const IndexT next = table[j].lf;
+            table[j].lf |= MSB<IndexT>;
+            j = next;
+        } while (j != row);
+    }
+}
+
+// multithreaded unbbwt: each thread goes through its rows and follows their cycles, giving up as soon as it meets
+// a smaller row, so that each cycle is decoded by the thread owning its smallest row. The rows met along the way
+// belong to cycles that are decoded anyway, so they are marked and skipped later.
+// The factors are decoded in per-thread buffers and then copied in place
+template<typename CharT, typename IndexT>
+void unbbwt(const CharT *const input, const IndexT length, CharT *const output, const unsigned threads)
+{
+    if (threads <= 1 || length < 2)
+    {
+        unbbwt(input, length, output);
+        return;
+    }
+
+    const vector<LFEntry<CharT, IndexT>> table = lfTable(input, length, threads);
+    vector<atomic<bool>> taken(length);
+
+    // the cycles found by each thread: smallest row, start in the buffer of the thread and length
+    struct Cycle
+    {
+        IndexT row;
+        IndexT start;
+        IndexT length;
+        unsigned long thread;
+    };
+    vector<vector<CharT>> buffers(threads);
+    vector<vector<Cycle>> cycles(threads);
+    parallelFor(0, threads, threads, [&](const unsigned long first_thread, const unsigned long last_thread)
+    {
+        for (unsigned long t = first_thread; t < last_thread; ++t)
+        {
+            vector<CharT> &buffer = buffers[t];
+            for (IndexT row = length * t / threads; row < length * (t + 1) / threads; ++row)
+            {
+                if (taken[row].load(memory_order_relaxed))
+                {
+                    continue;
+                }
+                const IndexT start = buffer.size();
+                IndexT j = row;
+                do
+                {
+                    buffer.push_back(table[j].symbol);
+                    taken[j].store(true, memory_order_relaxed);
+                    j = table[j].lf;
+                } while (j > row);
+                if (j != row)
+                {
+                    buffer.resize(start);
+                    continue;
+                }
+                cycles[t].push_back({row, start, static_cast<IndexT>(buffer.size() - start), t});
+            }
+        }
+    });
+
+    // cycles by increasing smallest row, written from the end of the output
+    vector<Cycle> all;
+    for (const vector<Cycle> &found : cycles)
+    {
+        all.insert(all.end(), found.begin(), found.end());
+    }
+    sort(all.begin(), all.end(), [](const Cycle &a, const Cycle &b) { return a.row < b.row; });
+    vector<IndexT> end(all.size());
+    IndexT position = length;
+    for (unsigned long c = 0; c < all.size(); ++c)
+    {
+        end[c] = position;
+        position -= all[c].length;
+    }
+    parallelFor(0, all.size(), threads, [&](const unsigned long first, const unsigned long last)
+    {
+        for (unsigned long c = first; c < last; ++c)
+        {
+            const CharT *const decoded = buffers[all[c].thread].data() + all[c].start;
+            reverse_copy(decoded, decoded + all[c].length, output + end[c] - all[c].length);
+        }
+    });
+}
+
+#endif
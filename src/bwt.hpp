@@ -0,0 +1,115 @@
+#ifndef BWT_HPP
+#define BWT_HPP
+
+// Burrows-Wheeler transform of input$ from its suffix array, where $ is a sentinel smaller than every symbol.
+// The sentinel is not stored: its row (the primary index) is returned instead, as usual in compressors.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <vector>
+using namespace std;
+
+// number of symbols converted at a time when writing to a stream
+constexpr unsigned long BWT_BLOCK_SYMBOLS = 1UL << 16;
+
+// symbol of row `row` of the BWT without the sentinel: row 0 is the rotation starting with $,
+// rows 1..length are the suffixes in SA order. Undefined for the primary index
+template<typename CharT, typename IndexT>
+CharT bwtSymbol(const CharT *const input, const IndexT *const SA, const IndexT length, const IndexT row)
+{
+    return row == 0 ? input[length - 1] : input[SA[row - 1] - 1];
+}
+
+// writes the length symbols of the BWT to output, returns the primary index
+template<typename CharT, typename IndexT>
+IndexT bwtFromSA(const CharT *const input, const IndexT *const SA, const IndexT length, CharT *const output)
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    IndexT primary = 0;
+    IndexT j = 0;
+    for (IndexT row = 0; row <= length; ++row)
+    {
+        if (row > 0 && SA[row - 1] == 0)
+        {
+            primary = row;
+            continue;
+        }
+        output[j++] = bwtSymbol(input, SA, length, row);
+    }
+    return primary;
+}
+
+// writes symbols to a binary stream a block at a time, each with its lowest bytes_per_char bytes
+// (in the same layout readFile expects)
+template<typename CharT>
+class SymbolWriter
+{
+public:
+    SymbolWriter(ostream &out, const unsigned long bytes_per_char)
+        : out(out), bytes_per_char(bytes_per_char), block(BWT_BLOCK_SYMBOLS * bytes_per_char), used(0) {}
+
+    ~SymbolWriter() { flush(); }
+
+    void put(const CharT symbol)
+    {
+        memcpy(block.data() + used * bytes_per_char, &symbol, bytes_per_char);
+        if (++used == BWT_BLOCK_SYMBOLS)
+        {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        out.write(block.data(), used * bytes_per_char);
+        used = 0;
+    }
+
+private:
+    ostream &out;
+    const unsigned long bytes_per_char;
+    vector<char> block;
+    unsigned long used;
+};
+
+// same as bwtFromSA, but the symbols are written to a binary stream
+template<typename CharT, typename IndexT>
+IndexT writeBWT(const CharT *const input, const IndexT *const SA, const IndexT length, ostream &out, const unsigned long bytes_per_char = sizeof(CharT))
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    SymbolWriter<CharT> writer(out, bytes_per_char);
+    IndexT primary = 0;
+    for (IndexT row = 0; row <= length; ++row)
+    {
+        if (row > 0 && SA[row - 1] == 0)
+        {
+            primary = row;
+            continue;
+        }
+        writer.put(bwtSymbol(input, SA, length, row));
+    }
+    return primary;
+}
+
+// a BWT file: the primary index as 8 bytes, in the byte order of the machine, followed by the symbols as
+// written by writeBWT. It is known before the symbols, from the row of the suffix starting at 0
+template<typename CharT, typename IndexT>
+IndexT writeBWTFile(const CharT *const input, const IndexT *const SA, const IndexT length, ostream &out, const unsigned long bytes_per_char = sizeof(CharT))
+{
+    const uint64_t primary = length == 0 ? 0 : find(SA, SA + length, 0) - SA + 1;
+    out.write(reinterpret_cast<const char *>(&primary), sizeof(primary));
+    writeBWT(input, SA, length, out, bytes_per_char);
+    return static_cast<IndexT>(primary);
+}
+
+#endif
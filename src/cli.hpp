@@ -5,25 +5,108 @@
 #include "utils.hpp"
 using namespace std;
 
-void suffixArray(const char* const input_word, const unsigned long word_length, const bool verbose) {
+// uses a 32-bit conjugate array when possible, as the suffix array
+template<typename CharT>
+void computeAndPrintConjugateArray(const CharT* const input, const unsigned long length, const SuffixArrayOptions& options, const string& array_name) {
+    if (length <= maxLengthFor<uint32_t>()) {
+        uint32_t* const CA = new uint32_t[length];
+        conjugateArray(input, CA, static_cast<uint32_t>(length), options);
+        aux_PrintArray(CA, length, array_name);
+        delete[] CA;
+    }
+    else {
+        unsigned long* const CA = new unsigned long[length];
+        conjugateArray(input, CA, length, options);
+        aux_PrintArray(CA, length, array_name);
+        delete[] CA;
+    }
+}
+
+void conjugateArray(const char* const input_word, const unsigned long word_length, const bool verbose, const SuffixArrayOptions& options = SuffixArrayOptions()) {
     if (word_length == 0) {
         cout << "Please provide a non-empty word." << endl;
         return;
     }
 
     if (verbose) {
-        cout << "Computing suffix array for the word: " << input_word << endl;
+        cout << "Computing conjugate array for the word: " << string(input_word, word_length) << endl;
     }
 
-    unsigned long* const SA = new unsigned long[word_length];
-    optimalSuffixArray(input_word, SA, word_length);
+    computeAndPrintConjugateArray(input_word, word_length, options, "");
+}
 
-    aux_PrintArray(SA, word_length);
+template<typename SymbolT>
+void conjugateArray(const SymbolT* const input_chars, const unsigned long word_length, const bool verbose, const SuffixArrayOptions& options = SuffixArrayOptions()) {
+    if (word_length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
 
-    delete[] SA;
+    if (verbose) {
+        aux_PrintArray(input_chars, word_length, "Input array");
+    }
+
+    computeAndPrintConjugateArray(input_chars, word_length, options, "Conjugate Array");
 }
 
-void suffixArray(const unsigned long* const input_chars, const unsigned long word_length, const bool verbose) {
+// the multithreaded construction needs one more array, with a single thread no memory is used besides LCP
+template<typename CharT, typename IndexT>
+void computeAndPrintLCP(const CharT* const input, IndexT* const SA, const IndexT length, const unsigned threads) {
+    IndexT* const LCP = new IndexT[length];
+    if (threads > 1) {
+        lcpArray(input, SA, length, LCP, threads);
+    }
+    else {
+        lcpArray_inPlace(input, SA, length, LCP);
+    }
+    aux_PrintArray(LCP, length, "LCP Array");
+    delete[] LCP;
+}
+
+// uses a 32-bit suffix array when possible, halving the memory used
+template<typename CharT>
+void computeAndPrintSuffixArray(const CharT* const input, const unsigned long length, const SuffixArrayOptions& options, const bool verbose, const string& array_name, const bool lcp) {
+    SuffixArrayEngine used;
+    if (length <= maxLengthFor<uint32_t>()) {
+        uint32_t* const SA = new uint32_t[length];
+        used = computeSuffixArray(input, SA, static_cast<uint32_t>(length), options);
+        aux_PrintArray(SA, length, array_name);
+        if (lcp) {
+            computeAndPrintLCP(input, SA, static_cast<uint32_t>(length), options.threads);
+        }
+        delete[] SA;
+    }
+    else {
+        unsigned long* const SA = new unsigned long[length];
+        used = computeSuffixArray(input, SA, length, options);
+        aux_PrintArray(SA, length, array_name);
+        if (lcp) {
+            computeAndPrintLCP(input, SA, length, options.threads);
+        }
+        delete[] SA;
+    }
+
+    if (verbose && used != options.engine) {
+        cout << "The requested engine exceeds the memory budget, the in-place engine was used instead." << endl;
+    }
+}
+
+void suffixArray(const char* const input_word, const unsigned long word_length, const bool verbose, const SuffixArrayOptions& options = SuffixArrayOptions(), const bool lcp = false) {
+    if (word_length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
+
+    if (verbose) {
+        cout << "Computing suffix array for the word: " << input_word << endl;
+    }
+
+    computeAndPrintSuffixArray(input_word, word_length, options, verbose, "", lcp);
+}
+
+// wide symbols: uint16_t and uint32_t keep 2 and 4 bytes per symbol files at their size in memory
+template<typename SymbolT>
+void suffixArray(const SymbolT* const input_chars, const unsigned long word_length, const bool verbose, const SuffixArrayOptions& options = SuffixArrayOptions(), const bool lcp = false) {
     if (word_length == 0) {
         cout << "Please provide a non-empty word." << endl;
         return;
@@ -33,38 +116,359 @@ void suffixArray(const unsigned long* const input_chars, const unsigned long wor
         aux_PrintArray(input_chars, word_length, "Input array");
     }
 
-    unsigned long* const SA = new unsigned long[word_length];
-    optimalSuffixArray((unsigned long* const) input_chars, SA, word_length);
+    computeAndPrintSuffixArray(input_chars, word_length, options, verbose, "Suffix Array", lcp);
+}
+
+// TextOrder also prints the rows of the samples, sparse sorts the sampled suffixes without the full suffix array
+template<typename CharT, typename IndexT>
+void computeAndPrintSampledSuffixArray(const CharT* const input, const IndexT length, const IndexT rate, const string& sampling, const SuffixArrayOptions& options) {
+    if (sampling == "sparse") {
+        const vector<IndexT> sparse = sparseSuffixArray(input, length, rate, options);
+        aux_PrintArray(sparse.data(), sparse.size(), "Sparse Suffix Array");
+        return;
+    }
+
+    const SampledSuffixArray<IndexT> sampled = sampledSuffixArray(input, length, rate, sampling == "text" ? SamplingMode::TextOrder : SamplingMode::SuffixArrayOrder, options);
+    aux_PrintArray(sampled.samples.data(), sampled.samples.size(), "Sampled Suffix Array");
+    if (sampled.mode == SamplingMode::TextOrder) {
+        vector<IndexT> rows;
+        for (IndexT row = 0; row < length; ++row) {
+            if (sampled.isSampled(row)) rows.push_back(row);
+        }
+        aux_PrintArray(rows.data(), rows.size(), "Sampled rows");
+    }
+}
+
+template<typename CharT>
+void sampledSuffixArray(const CharT* const input, const unsigned long length, const unsigned long rate, const string& sampling, const bool verbose, const SuffixArrayOptions& options) {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
+
+    if (verbose) {
+        cout << "Computing suffix array sampled every " << rate << (sampling == "sa" ? " rows" : " positions") << endl;
+    }
+    if (length <= maxLengthFor<uint32_t>()) {
+        computeAndPrintSampledSuffixArray(input, static_cast<uint32_t>(length), static_cast<uint32_t>(rate), sampling, options);
+    }
+    else {
+        computeAndPrintSampledSuffixArray(input, length, rate, sampling, options);
+    }
+}
+
+// the factors are printed as their starting positions
+template<typename CharT>
+void lyndonFactorization(const CharT* const input, const unsigned long length, const bool verbose, const unsigned threads) {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
 
-    aux_PrintArray(SA, word_length, "Suffix Array");
+    const auto print = [verbose](const auto& boundaries) {
+        if (verbose) {
+            cout << "Lyndon factors: " << boundaries.size() - 1 << endl;
+        }
+        aux_PrintArray(boundaries.data(), boundaries.size() - 1, "Factor starts");
+    };
+    if (length <= numeric_limits<uint32_t>::max()) {
+        print(duvalBoundaries(input, static_cast<uint32_t>(length), threads));
+    }
+    else {
+        print(duvalBoundaries(input, length, threads));
+    }
+}
+
+// the suffix array is only kept in memory, the BWT goes straight to the output file after the primary index.
+// Returns the primary index
+template<typename CharT>
+unsigned long computeAndWriteBWT(const CharT* const input, const unsigned long length, ofstream& out, const unsigned long bytes_per_char, const SuffixArrayOptions& options) {
+    unsigned long primary;
+    if (length <= maxLengthFor<uint32_t>()) {
+        uint32_t* const SA = new uint32_t[length];
+        computeSuffixArray(input, SA, static_cast<uint32_t>(length), options);
+        primary = writeBWTFile(input, SA, static_cast<uint32_t>(length), out, bytes_per_char);
+        delete[] SA;
+    }
+    else {
+        unsigned long* const SA = new unsigned long[length];
+        computeSuffixArray(input, SA, length, options);
+        primary = writeBWTFile(input, SA, length, out, bytes_per_char);
+        delete[] SA;
+    }
+    return primary;
+}
+
+template<typename CharT>
+void bwt(const CharT* const input, const unsigned long length, const string& output_file, const unsigned long bytes_per_char, const bool verbose, const SuffixArrayOptions& options = SuffixArrayOptions()) {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
+
+    ofstream out(output_file, ios::binary);
+    if (!out) {
+        cerr << "Failed to open output file.\n";
+        return;
+    }
+
+    const unsigned long primary = computeAndWriteBWT(input, length, out, bytes_per_char, options);
+    if (!out) {
+        cerr << "Failed to write output file.\n";
+        return;
+    }
+    if (verbose) {
+        cout << "Primary index: " << primary << endl;
+        cout << "BWT of " << length << " characters written to " << output_file << endl;
+    }
+}
+
+template<typename CharT>
+void bijectiveBWT(const CharT* const input, const unsigned long length, const string& output_file, const unsigned long bytes_per_char, const bool verbose) {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
 
+    ofstream out(output_file, ios::binary);
+    if (!out) {
+        cerr << "Failed to open output file.\n";
+        return;
+    }
+
+    if (length <= maxLengthFor<uint32_t>()) {
+        uint32_t* const SA = new uint32_t[length];
+        writeBBWT(input, SA, static_cast<uint32_t>(length), out, bytes_per_char);
+        delete[] SA;
+    }
+    else {
+        unsigned long* const SA = new unsigned long[length];
+        writeBBWT(input, SA, length, out, bytes_per_char);
+        delete[] SA;
+    }
+    if (!out) {
+        cerr << "Failed to write output file.\n";
+        return;
+    }
+    if (verbose) {
+        cout << "BBWT of " << length << " characters written to " << output_file << endl;
+    }
+}
+
+template<typename CharT>
+void inverseBijectiveBWT(const CharT* const input, const unsigned long length, const string& output_file, const unsigned long bytes_per_char, const bool verbose, const unsigned threads) {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
+
+    ofstream out(output_file, ios::binary);
+    if (!out) {
+        cerr << "Failed to open output file.\n";
+        return;
+    }
+
+    CharT* const decoded = new CharT[length];
+    if (length <= maxLengthFor<uint32_t>()) {
+        unbbwt(input, static_cast<uint32_t>(length), decoded, threads);
+    }
+    else {
+        unbbwt(input, length, decoded, threads);
+    }
+    {
+        SymbolWriter<CharT> writer(out, bytes_per_char);
+        for (unsigned long i = 0; i < length; ++i) {
+            writer.put(decoded[i]);
+        }
+    }
+    delete[] decoded;
+    if (!out) {
+        cerr << "Failed to write output file.\n";
+        return;
+    }
+    if (verbose) {
+        cout << "Text of " << length << " characters written to " << output_file << endl;
+    }
+}
+
+template<typename IndexT>
+void computeAndWriteEBWT(const char* const words, const vector<unsigned long>& starts, ofstream& out) {
+    const vector<IndexT> word_starts(starts.begin(), starts.end());
+    const IndexT length = starts.back();
+    IndexT* const SA = new IndexT[length];
+    writeEBWT(words, word_starts.data(), static_cast<IndexT>(word_starts.size() - 1), SA, out);
     delete[] SA;
 }
 
-void showTrees(const char* const input_word, const bool verbose) {
+void extendedBWT(const string& input_file, const string& output_file, const bool verbose) {
+    vector<unsigned long> starts;
+    char* const words = readWords(input_file, starts);
+    if (!words) {
+        return;
+    }
+    if (starts.size() < 2) {
+        cout << "Please provide at least one non-empty word." << endl;
+        delete[] words;
+        return;
+    }
+
+    ofstream out(output_file, ios::binary);
+    if (!out) {
+        cerr << "Failed to open output file.\n";
+        delete[] words;
+        return;
+    }
+
+    if (starts.back() <= maxLengthFor<uint32_t>()) {
+        computeAndWriteEBWT<uint32_t>(words, starts, out);
+    }
+    else {
+        computeAndWriteEBWT<unsigned long>(words, starts, out);
+    }
+    delete[] words;
+    if (!out) {
+        cerr << "Failed to write output file.\n";
+        return;
+    }
+    if (verbose) {
+        cout << "eBWT of " << starts.size() - 1 << " words (" << starts.back() << " characters) written to " << output_file << endl;
+    }
+}
+
+// the suffixes are printed as (document, offset) pairs
+template<typename IndexT>
+void computeAndPrintGeneralizedSuffixArray(const char* const text, const vector<unsigned long>& starts, const SuffixArrayOptions& options) {
+    const vector<IndexT> document_starts(starts.begin(), starts.end());
+    const IndexT documents = document_starts.size() - 1;
+    const IndexT length = starts.back();
+    IndexT* const SA = new IndexT[length + documents];
+    generalizedSuffixArray(reinterpret_cast<const uint8_t*>(text), document_starts.data(), documents, SA, options);
+    cout << "Generalized Suffix Array: ";
+    for (IndexT i = 0; i < length; ++i) {
+        const IndexT document = documentOf(document_starts.data(), documents, SA[i]);
+        if (i) cout << ", ";
+        cout << "(" << document << ", " << SA[i] - document_starts[document] << ")";
+    }
+    cout << endl;
+    delete[] SA;
+}
+
+void corpusSuffixArray(const vector<string>& filenames, const bool verbose, const SuffixArrayOptions& options = SuffixArrayOptions()) {
+    vector<unsigned long> starts;
+    char* const text = readDocuments(filenames, starts);
+    if (!text) {
+        return;
+    }
+
+    if (verbose) {
+        cout << "Computing generalized suffix array of " << filenames.size() << " documents (" << starts.back() << " characters)" << endl;
+    }
+    if (starts.back() + filenames.size() <= maxLengthFor<uint32_t>()) {
+        computeAndPrintGeneralizedSuffixArray<uint32_t>(text, starts, options);
+    }
+    else {
+        computeAndPrintGeneralizedSuffixArray<unsigned long>(text, starts, options);
+    }
+    delete[] text;
+}
+
+// prints the factors of the given rotations, or of all of them, each one answered by the same RotationFactorization.
+// It is read from factorization_file if given, which must have been written for the same word
+void rotationFactors(const char* const word, const unsigned long length, vector<unsigned long> rotations, const bool verbose, const string& factorization_file = "") {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
+    RotationFactorization factorization;
+    if (factorization_file.empty()) {
+        factorization = RotationFactorization(word, length);
+    }
+    else {
+        ifstream in(factorization_file, ios::binary);
+        if (!factorization.read(in)) {
+            cerr << "Failed to read the factorization file " << factorization_file << ".\n";
+            return;
+        }
+        if (factorization.length() != length) {
+            cerr << "The factorization file is for a word of length " << factorization.length() << ", not " << length << ".\n";
+            return;
+        }
+    }
+    if (verbose) {
+        cout << "Least rotation at index " << factorization.leastRotation() << ", primitive root of length " << factorization.period() << endl;
+    }
+    if (rotations.empty()) {
+        for (unsigned long i = 0; i < length; ++i) rotations.push_back(i);
+    }
+
+    vector<pair<unsigned long, unsigned long>> factors;
+    for (const unsigned long i : rotations) {
+        if (i >= length) {
+            cout << "Rotation " << i << " does not exist, the word has length " << length << endl;
+            continue;
+        }
+        factorization.factorize(i, factors);
+        cout << "Factors of rotation " << i << ": ";
+        for (unsigned long f = 0; f < factors.size(); ++f) {
+            if (f) cout << ", ";
+            for (unsigned long k = 0; k < factors[f].second; ++k) {
+                cout << word[(i + factors[f].first + k) % length];
+            }
+        }
+        cout << endl;
+    }
+}
+
+// writes Lyn, LynS and the least rotation, from which the factors of every rotation can be read back
+void saveRotationFactors(const char* const word, const unsigned long length, const string& output_file, const string& encoding, const bool verbose) {
+    if (length == 0) {
+        cout << "Please provide a non-empty word." << endl;
+        return;
+    }
+    ofstream out(output_file, ios::binary);
+    if (!out) {
+        cerr << "Failed to open output file.\n";
+        return;
+    }
+    const RotationFactorization factorization(word, length);
+    factorization.write(out, encoding == "varint" ? FactorizationEncoding::Varint : FactorizationEncoding::Fixed32);
+    if (verbose) {
+        cout << "Wrote " << out.tellp() << " bytes for " << length << " rotations to " << output_file << endl;
+    }
+}
+
+void showTrees(const char* const input_word, const bool verbose, const unsigned threads = 1) {
     const unsigned long word_length = strlen(input_word);
     char * const word = new char[word_length+1];
     const unsigned long least = least_rotation(input_word, word_length);
     rotate_copy(input_word, input_word+least, input_word+word_length, word);
     word[word_length] = '\0';
-    vector<string> factors = duval(string(word));
-    if (factors.size()!=1){
+    const unsigned long root_length = firstLyndonFactorLength(word, word_length);
+    if (root_length != word_length){
         if (verbose) {
-            cout << word << " is periodic, trees are not defined: showing trees for its primitive root: " << factors[0] << endl;
+            cout << word << " is periodic, trees are not defined: showing trees for its primitive root: " << string_view(word, root_length) << endl;
         }
+        word[root_length] = '\0';
+        showTrees(word, verbose, threads);
         delete[] word;
-        showTrees(factors[0].c_str(), verbose);
         return;
     }
     
     unsigned long *LynS = new unsigned long[word_length];
     unsigned long *Lyn = new unsigned long[word_length];
-    unsigned long *rank = new unsigned long[word_length];
     unsigned long *SA = new unsigned long[word_length];
     Node** roots = new Node* [word_length];
 
+    // with a single thread the rank array replaces the suffix array
     optimalSuffixArray(word, SA, word_length);
-    rankArrayFromSA(SA, word_length, rank);
+    unsigned long *rank = SA;
+    if (threads > 1) {
+        rank = new unsigned long[word_length];
+        rankArrayFromSA(SA, word_length, rank, threads);
+    }
+    else {
+        rankArrayFromSA_inPlace(SA, word_length);
+    }
     LyndonSuffixTable(word, word_length, LynS);
     LongestLyndon(word, word_length, rank, Lyn);
     Node* leftTree = LeftLyndonTree(word, word_length, LynS, roots);
@@ -84,7 +488,7 @@ void showTrees(const char* const input_word, const bool verbose) {
     delete[] word;
     delete[] LynS;
     delete[] Lyn;
-    delete[] rank;
+    if (rank != SA) delete[] rank;
     delete[] SA;
     delete[] roots;
     delete leftTree;
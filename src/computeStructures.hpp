@@ -1,6 +1,10 @@
 #ifndef COMPUTE_STRUCTURES_HPP
 #define COMPUTE_STRUCTURES_HPP
 
+#include <vector>
+#include "optimalSuffixArray.hpp"
+#include "parallel.hpp"
+
 void LyndonSuffixTable(const char* const y, const unsigned long n, unsigned long* const LynS) {
     LynS[0] = 1;
     unsigned long per = 1;
@@ -30,6 +34,78 @@ void LongestLyndon(const char* const word, const unsigned long length, const uns
     }
 }
 
+// Lyn without the suffix array: Lyn[i] = NSS[i] - i, where NSS[i] is the next suffix smaller than suffix i.
+// Right to left, suffix i is compared with i + 1 and then with the next smaller suffixes, which are the starts
+// of the Lyndon factors of suffix i + 1. As in "Space Efficient Construction of Lyndon Arrays in Linear Time"
+// (Bille, Ellert, Fischer, Gørtz, Kurpicz, Munro, Rotenberg), the lce of each factor with the next one is kept
+// on a stack, so that most comparisons need no symbol at all. Besides Lyn, the stack holds one word per factor.
+// About one symbol comparison per position on random text, a few more on very repetitive text
+void LongestLyndonDirect(const char* const input_word, const unsigned long length, unsigned long * const Lyn) {
+    const unsigned char* const word = reinterpret_cast<const unsigned char*>(input_word);
+    vector<unsigned long> lce; // lce of each factor of the current suffix with the next one, the first factor on top
+    unsigned long run_end = length; // word[start, run_end) is a run of the same symbol
+    unsigned long repetition_period = 0; // word[repetition_start, repetition_end) is the last measured repetition
+    unsigned long repetition_start = length;
+    unsigned long repetition_end = length;
+    for (unsigned long i = length; i > 0; --i) {
+        const unsigned long start = i - 1;
+        if (i == length || word[start] != word[i]) {
+            run_end = i;
+        }
+
+        // suffix start against suffix start + 1: they agree up to the end of the run
+        unsigned long j = i;
+        unsigned long common = run_end - i;
+        bool smaller = run_end < length && word[start] < word[run_end];
+        while (smaller) {
+            const unsigned long next = j + Lyn[j];
+            const unsigned long next_common = lce.back();
+            lce.pop_back();
+            j = next;
+            if (next == length) {
+                break;
+            }
+            if (common > next_common) {
+                common = next_common;
+                smaller = false;
+            }
+            else if (common == next_common) {
+                // if word[start, next) is repeated, the lce is the length of the repetition minus one period:
+                // it is known if the next repetition is a factor on its own, or if the repetition was already measured
+                const unsigned long period = next - start;
+                while (common < period && next + common < length && word[start + common] == word[next + common]) {
+                    ++common;
+                }
+                if (common >= period) {
+                    if (Lyn[next] == period) {
+                        common = period + lce.back();
+                    }
+                    else {
+                        // the last measured repetition is extended to the left one symbol at a time
+                        while (period == repetition_period && repetition_start > start && word[repetition_start - 1] == word[repetition_start - 1 + period]) {
+                            --repetition_start;
+                        }
+                        if (period == repetition_period && repetition_start == start) {
+                            common = repetition_end - next;
+                        }
+                        else {
+                            while (next + common < length && word[start + common] == word[next + common]) {
+                                ++common;
+                            }
+                            repetition_period = period;
+                            repetition_start = start;
+                            repetition_end = next + common;
+                        }
+                    }
+                }
+                smaller = next + common < length && word[start + common] < word[next + common];
+            }
+        }
+        Lyn[start] = j - start;
+        lce.push_back(j == length ? 0 : common);
+    }
+}
+
 void ComputeNNS(const char* const word, const unsigned long length, unsigned long * const NNS)
 {
     NNS[length-1] = length;
@@ -42,10 +118,85 @@ void ComputeNNS(const char* const word, const unsigned long length, unsigned lon
     }
 }
 
-void rankArrayFromSA(const unsigned long * const SA, const unsigned long n, unsigned long * const rank) {
-    for (unsigned long i = 0; i < n; ++i){
+template<typename IndexT>
+void rankArrayFromSA(const IndexT * const SA, const IndexT n, IndexT * const rank) {
+    for (IndexT i = 0; i < n; ++i){
         rank[SA[i]] = i;
     }
 }
 
+// ranks scattered by a block stay in cache
+constexpr unsigned long RANK_BLOCK = 1UL << 17;
+
+// same as rankArrayFromSA, but the positions of SA are first grouped by the block of rank they write to,
+// so that each block is then written on its own. Uses n more words, each pass runs on multiple threads
+template<typename IndexT>
+void rankArrayFromSA(const IndexT * const SA, const IndexT n, IndexT * const rank, const unsigned threads) {
+    const unsigned long blocks = (n + RANK_BLOCK - 1) / RANK_BLOCK;
+    if (blocks <= 1) {
+        rankArrayFromSA(SA, n, rank);
+        return;
+    }
+
+    // offsets[chunk * blocks + b] = where the positions of chunk writing to block b go
+    const unsigned long chunks = min<unsigned long>(max(threads, 1U), n);
+    vector<IndexT> offsets(chunks * blocks, 0);
+    parallelFor(0, chunks, chunks, [&](const unsigned long first, const unsigned long last) {
+        for (unsigned long chunk = first; chunk < last; ++chunk) {
+            for (IndexT i = n * chunk / chunks; i < n * (chunk + 1) / chunks; ++i) {
+                ++offsets[chunk * blocks + SA[i] / RANK_BLOCK];
+            }
+        }
+    });
+    vector<IndexT> blockStart(blocks + 1);
+    IndexT sum = 0;
+    for (unsigned long b = 0; b < blocks; ++b) {
+        blockStart[b] = sum;
+        for (unsigned long chunk = 0; chunk < chunks; ++chunk) {
+            const IndexT count = offsets[chunk * blocks + b];
+            offsets[chunk * blocks + b] = sum;
+            sum += count;
+        }
+    }
+    blockStart[blocks] = n;
+
+    vector<IndexT> grouped(n);
+    parallelFor(0, chunks, chunks, [&](const unsigned long first, const unsigned long last) {
+        for (unsigned long chunk = first; chunk < last; ++chunk) {
+            for (IndexT i = n * chunk / chunks; i < n * (chunk + 1) / chunks; ++i) {
+                grouped[offsets[chunk * blocks + SA[i] / RANK_BLOCK]++] = i;
+            }
+        }
+    });
+
+    parallelFor(0, blocks, threads, [&](const unsigned long first, const unsigned long last) {
+        for (IndexT k = blockStart[first]; k < blockStart[last]; ++k) {
+            rank[SA[grouped[k]]] = grouped[k];
+        }
+    });
+}
+
+// SA becomes the rank array, following the cycles of the permutation.
+// The entries already inverted are marked with the MSB, as in optimalSuffixArray
+template<typename IndexT>
+void rankArrayFromSA_inPlace(IndexT * const SA, const IndexT n) {
+    for (IndexT start = 0; start < n; ++start) {
+        if (SA[start] & MSB<IndexT>) {
+            continue;
+        }
+        IndexT previous = start;
+        IndexT current = SA[start];
+        while (current != start) {
+            const IndexT next = SA[current];
+            SA[current] = previous | MSB<IndexT>;
+            previous = current;
+            current = next;
+        }
+        SA[start] = previous | MSB<IndexT>;
+    }
+    for (IndexT i = 0; i < n; ++i) {
+        SA[i] &= ~MSB<IndexT>;
+    }
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#ifndef CONJUGATE_ARRAY_HPP
+#define CONJUGATE_ARRAY_HPP
+
+// Circular suffix array (conjugate array): the starting positions of the rotations of the input, sorted.
+// For a Lyndon word, the order of its suffixes is the order of the rotations starting at the same positions.
+// The least rotation of a primitive input is a Lyndon word, so its suffix array sorts the rotations. A periodic
+// input is r^k for a Lyndon word r: each rotation of r appears k times, one after the other. No doubling of the
+// text is needed.
+
+#include <algorithm>
+#include <vector>
+#include "duval.hpp"
+#include "leastRotation.hpp"
+#include "suffixArrayEngine.hpp"
+using namespace std;
+
+// the input read from position start, wrapping around its end
+template<typename CharT, typename IndexT>
+struct RotatedText
+{
+    const CharT *text;
+    IndexT length;
+    IndexT start;
+
+    CharT operator[](const IndexT i) const
+    {
+        return text[i < length - start ? start + i : i - (length - start)];
+    }
+};
+
+// CA gets the positions of the rotations of input in lexicographic order, equal rotations by increasing position
+template<typename CharT, typename IndexT>
+void conjugateArray(const CharT *const input, IndexT *const CA, const IndexT length, const SuffixArrayOptions &options = SuffixArrayOptions())
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    // the root r is the first Lyndon factor of the least rotation. Every copy of r in the input starts at
+    // least modulo the period, so a periodic input contains r without wrapping around: its suffix array is
+    // built in place. Only a primitive input whose least rotation wraps around is copied, one symbol per position
+    const IndexT least = least_rotation_lyndon(input, length);
+    const IndexT period = firstLyndonFactorLength(RotatedText<CharT, IndexT>{input, length, least}, length);
+    const IndexT start = least % period;
+    if (start + period <= length)
+    {
+        computeSuffixArray(input + start, CA, period, options);
+    }
+    else
+    {
+        vector<CharT> root(length);
+        rotate_copy(input, input + least, input + length, root.begin());
+        computeSuffixArray(root.data(), CA, period, options);
+    }
+
+    // from the back, so that entries are read before being overwritten.
+    // Equal rotations start at the same offset of each repetition of the root
+    const IndexT repetitions = length / period;
+    for (IndexT i = period; i > 0; --i)
+    {
+        const IndexT offset = (start + CA[i - 1]) % period;
+        for (IndexT j = repetitions; j > 0; --j)
+        {
+            CA[(i - 1) * repetitions + j - 1] = offset + (j - 1) * period;
+        }
+    }
+}
+
+// bytes are compared as unsigned, consistently with the suffix array
+template<typename IndexT>
+void conjugateArray(const char *const input, IndexT *const CA, const IndexT length, const SuffixArrayOptions &options = SuffixArrayOptions())
+{
+    conjugateArray(reinterpret_cast<const uint8_t *>(input), CA, length, options);
+}
+
+#endif
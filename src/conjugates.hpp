@@ -0,0 +1,307 @@
+#ifndef CONJUGATES_HPP
+#define CONJUGATES_HPP
+
+// Sorting of the conjugates of a multiset of words in omega-order (u before v if u^ω < v^ω), used by the
+// bijective BWT. It is SA-IS where the successor of the last symbol of a word is its first symbol, described in:
+// "Constructing the Bijective and the Extended Burrows-Wheeler Transform in Linear Time" (Bannai, Kärkkäinen, Köppl, Piątkowski)
+// Conjugates with the same omega-word end up in any order among themselves.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "sais.hpp"
+using namespace std;
+
+// the words text[starts[w], starts[w + 1]), with starts[0] = 0 and starts[words] = length, read cyclically.
+// The starts of the words are marked in a bitvector with the number of marks before each 64-bit block,
+// so that the word containing a position is found in O(1) even with millions of short words
+template<typename IndexT>
+struct CyclicWords
+{
+    vector<IndexT> starts; // starts of the non-empty words, followed by length
+    vector<uint64_t> first; // bit i is set if a word starts at i, bit length is set
+    vector<IndexT> before; // before[b] = number of bits set in the blocks before b
+
+    CyclicWords(const IndexT *const word_starts, const IndexT words, const IndexT length)
+        : first(length / 64 + 1, 0)
+    {
+        for (IndexT w = 0; w <= words; ++w)
+        {
+            if (w == words || word_starts[w] != word_starts[w + 1])
+            {
+                starts.push_back(word_starts[w]);
+                first[word_starts[w] >> 6] |= 1ULL << (word_starts[w] & 63);
+            }
+        }
+        before.resize(first.size());
+        IndexT count = 0;
+        for (unsigned long b = 0; b < first.size(); ++b)
+        {
+            before[b] = count;
+            count += __builtin_popcountll(first[b]);
+        }
+    }
+
+    bool isFirst(const IndexT i) const
+    {
+        return (first[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // index among the non-empty words of the word containing i
+    IndexT wordOf(const IndexT i) const
+    {
+        const uint64_t upto = first[i >> 6] & (~0ULL >> (63 - (i & 63)));
+        return before[i >> 6] + __builtin_popcountll(upto) - 1;
+    }
+
+    IndexT next(const IndexT i) const
+    {
+        return isFirst(i + 1) ? starts[wordOf(i)] : i + 1;
+    }
+
+    IndexT prev(const IndexT i) const
+    {
+        return isFirst(i) ? starts[wordOf(i) + 1] - 1 : i - 1;
+    }
+};
+
+// sym(i) returns the i-th symbol of the text, in [0, upper]. Empty words are allowed
+template<typename IndexT, typename SymbolFn>
+void sortConjugates_core(const SymbolFn &sym, const IndexT *const starts, const IndexT words, IndexT *const SA, const IndexT length, const IndexT upper)
+{
+    constexpr IndexT EMPTY = numeric_limits<IndexT>::max();
+    // words made of a single repeated symbol are neither L nor S: c^ω falls between the L-type and the S-type conjugates starting with c
+    enum : uint8_t { L_TYPE, S_TYPE, CONSTANT };
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    const CyclicWords<IndexT> cycles(starts, words, length);
+    vector<uint8_t> type(length);
+    for (IndexT w = 0; w < words; ++w)
+    {
+        const IndexT begin = starts[w];
+        const IndexT end = starts[w + 1];
+        if (begin == end)
+        {
+            continue;
+        }
+
+        // the type of a symbol followed by a different one is known, the others take the type of their successor
+        IndexT j = end;
+        while (j > begin && sym(j - 1) == sym(cycles.next(j - 1)))
+        {
+            --j;
+        }
+        if (j == begin)
+        {
+            fill(type.begin() + begin, type.begin() + end, static_cast<uint8_t>(CONSTANT));
+            continue;
+        }
+        --j;
+        type[j] = sym(j) < sym(cycles.next(j)) ? S_TYPE : L_TYPE;
+        const auto setType = [&](const IndexT i)
+        {
+            const IndexT a = sym(i);
+            const IndexT b = sym(cycles.next(i));
+            type[i] = (a == b) ? type[cycles.next(i)] : static_cast<uint8_t>(a < b ? S_TYPE : L_TYPE);
+        };
+        for (IndexT i = j; i > begin; --i)
+        {
+            setType(i - 1);
+        }
+        for (IndexT i = end - 1; i > j; --i)
+        {
+            setType(i);
+        }
+    }
+
+    // bucket c is [bucketStart[c], bucketStart[c + 1]): L-type conjugates, then constant words, then S-type conjugates
+    vector<IndexT> bucketStart(upper + 2, 0);
+    vector<IndexT> countL(upper + 1, 0);
+    vector<IndexT> countConstant(upper + 1, 0);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        ++bucketStart[sym(i) + 1];
+        if (type[i] == L_TYPE)
+        {
+            ++countL[sym(i)];
+        }
+        else if (type[i] == CONSTANT)
+        {
+            ++countConstant[sym(i)];
+        }
+    }
+    for (IndexT c = 0; c <= upper; ++c)
+    {
+        bucketStart[c + 1] += bucketStart[c];
+    }
+
+    vector<IndexT> buffer(upper + 2);
+    const auto induce = [&](const vector<IndexT> &lms)
+    {
+        fill(SA, SA + length, EMPTY);
+
+        // constant words never induce other conjugates
+        for (IndexT c = 0; c <= upper; ++c)
+        {
+            buffer[c] = bucketStart[c] + countL[c];
+        }
+        for (IndexT i = 0; i < length; ++i)
+        {
+            if (type[i] == CONSTANT)
+            {
+                SA[buffer[sym(i)]++] = i;
+            }
+        }
+
+        // LMS conjugates at the head of the S-type part of their buckets, in the given order
+        for (IndexT c = 0; c <= upper; ++c)
+        {
+            buffer[c] = bucketStart[c] + countL[c] + countConstant[c];
+        }
+        for (const IndexT d : lms)
+        {
+            SA[buffer[sym(d)]++] = d;
+        }
+
+        // L-type conjugates, left to right
+        copy(bucketStart.begin(), bucketStart.end(), buffer.begin());
+        for (IndexT i = 0; i < length; ++i)
+        {
+            if (SA[i] != EMPTY)
+            {
+                const IndexT u = cycles.prev(SA[i]);
+                if (type[u] == L_TYPE)
+                {
+                    SA[buffer[sym(u)]++] = u;
+                }
+            }
+        }
+
+        // S-type conjugates, right to left
+        copy(bucketStart.begin(), bucketStart.end(), buffer.begin());
+        for (IndexT i = length; i > 0; --i)
+        {
+            if (SA[i - 1] != EMPTY)
+            {
+                const IndexT u = cycles.prev(SA[i - 1]);
+                if (type[u] == S_TYPE)
+                {
+                    SA[--buffer[sym(u) + 1]] = u;
+                }
+            }
+        }
+    };
+
+    // LMS positions in text order, with the number of symbols of their LMS substring:
+    // up to the next LMS position of the same word, included, going around the word if needed
+    vector<IndexT> lmsIndex(length, EMPTY);
+    vector<IndexT> lms;
+    vector<IndexT> lmsLength;
+    vector<IndexT> reducedStarts{0};
+    for (IndexT w = 0; w < words; ++w)
+    {
+        const IndexT firstLms = lms.size();
+        for (IndexT i = starts[w]; i < starts[w + 1]; ++i)
+        {
+            if (type[i] == S_TYPE && type[cycles.prev(i)] == L_TYPE)
+            {
+                lmsIndex[i] = lms.size();
+                lms.push_back(i);
+            }
+        }
+        const IndexT count = lms.size() - firstLms;
+        if (count == 0)
+        {
+            continue;
+        }
+        for (IndexT k = firstLms; k + 1 < lms.size(); ++k)
+        {
+            lmsLength.push_back(lms[k + 1] - lms[k] + 1);
+        }
+        lmsLength.push_back(starts[w + 1] - lms.back() + lms[firstLms] - starts[w] + 1);
+        reducedStarts.push_back(lms.size());
+    }
+    const IndexT m = lms.size();
+
+    // sort the LMS substrings
+    induce(lms);
+    if (m == 0)
+    {
+        return;
+    }
+
+    vector<IndexT> sortedLms;
+    sortedLms.reserve(m);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        if (lmsIndex[SA[i]] != EMPTY)
+        {
+            sortedLms.push_back(SA[i]);
+        }
+    }
+
+    // name the LMS substrings, the reduced words are the names of the LMS substrings of each word
+    vector<IndexT> reduced(m);
+    IndexT name = 0;
+    reduced[lmsIndex[sortedLms[0]]] = 0;
+    for (IndexT i = 1; i < m; ++i)
+    {
+        IndexT l = sortedLms[i - 1];
+        IndexT r = sortedLms[i];
+        const IndexT len = lmsLength[lmsIndex[l]];
+        bool same = len == lmsLength[lmsIndex[r]];
+        for (IndexT k = 0; same && k < len; ++k)
+        {
+            same = sym(l) == sym(r);
+            l = cycles.next(l);
+            r = cycles.next(r);
+        }
+        if (!same)
+        {
+            ++name;
+        }
+        reduced[lmsIndex[sortedLms[i]]] = name;
+    }
+    lmsIndex = vector<IndexT>();
+    lmsLength = vector<IndexT>();
+
+    // recursion, only needed if some LMS substrings are equal
+    if (name + 1 < m)
+    {
+        sortConjugates_core(ArraySymbols<IndexT>{reduced.data()}, reducedStarts.data(), static_cast<IndexT>(reducedStarts.size() - 1), SA, m, name);
+    }
+    else
+    {
+        for (IndexT i = 0; i < m; ++i)
+        {
+            SA[reduced[i]] = i;
+        }
+    }
+    for (IndexT i = 0; i < m; ++i)
+    {
+        sortedLms[i] = lms[SA[i]];
+    }
+    induce(sortedLms);
+}
+
+// SA gets the conjugates of the words input[starts[w], starts[w + 1]) in omega-order, each as its starting position in input
+template<typename CharT, typename IndexT>
+void sortConjugates(const CharT *const input, const IndexT *const starts, const IndexT words, IndexT *const SA, const IndexT length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    withSmallSymbols(input, length, [starts, words, SA, length](const auto &sym, const IndexT upper)
+    {
+        sortConjugates_core(sym, starts, words, SA, length, upper);
+    });
+}
+
+#endif
@@ -1,18 +1,21 @@
 #ifndef DUVAL_HPP
 #define DUVAL_HPP
 
+#include <algorithm>
 #include <vector>
 #include <string>
+#include <string_view>
+#include "parallel.hpp"
 using namespace std;
 
-vector<string> duval(string const &s)
+// calls visit(start, end) for each Lyndon factor s[start, end), from left to right
+template <typename CharT, typename IndexT, typename Visit>
+void duvalFactors(const CharT *const s, const IndexT n, const Visit &visit)
 {
-    int n = s.size();
-    int i = 0;
-    vector<string> factorization;
+    IndexT i = 0;
     while (i < n)
     {
-        int j = i + 1, k = i;
+        IndexT j = i + 1, k = i;
         while (j < n && s[k] <= s[j])
         {
             if (s[k] < s[j])
@@ -23,11 +26,123 @@ vector<string> duval(string const &s)
         }
         while (i <= k)
         {
-            factorization.push_back(s.substr(i, j - k));
+            visit(i, i + j - k);
             i += j - k;
         }
     }
+}
+
+// the factors as views of s, without copies
+vector<string_view> duvalViews(const string_view s)
+{
+    vector<string_view> factorization;
+    duvalFactors(s.data(), s.size(), [&](const size_t start, const size_t end) { factorization.push_back(s.substr(start, end - start)); });
+    return factorization;
+}
+
+vector<string> duval(string const &s)
+{
+    vector<string> factorization;
+    for (const string_view factor : duvalViews(s))
+    {
+        factorization.emplace_back(factor);
+    }
     return factorization;
 }
 
+// same factorization, as the starting positions of the factors followed by n
+template <typename CharT, typename IndexT>
+vector<IndexT> duvalBoundaries(const CharT *const s, const IndexT n)
+{
+    vector<IndexT> boundaries;
+    duvalFactors(s, n, [&](const IndexT start, IndexT) { boundaries.push_back(start); });
+    boundaries.push_back(n);
+    return boundaries;
+}
+
+// length of the first Lyndon factor, reading s only up to the end of the repetitions of that factor.
+// A least rotation r^k has r as first factor: it is primitive if the result is n.
+// s is a pointer or any view with s[i]
+template <typename TextT, typename IndexT>
+IndexT firstLyndonFactorLength(const TextT &s, const IndexT n)
+{
+    if (n == 0)
+    {
+        return 0;
+    }
+    IndexT j = 1, k = 0;
+    while (j < n && s[k] <= s[j])
+    {
+        if (s[k] < s[j])
+            k = 0;
+        else
+            k++;
+        j++;
+    }
+    return j - k;
+}
+
+// same boundaries, on multiple threads: each chunk is factorized on its own, then the factorizations are joined
+// from left to right. A factor is merged with the previous one while the previous one is smaller; as soon as a
+// factor of a chunk is not merged, the following ones are not smaller than it and are appended as they are
+template <typename CharT, typename IndexT>
+vector<IndexT> duvalBoundaries(const CharT *const s, const IndexT n, const unsigned threads)
+{
+    const unsigned long chunks = min<unsigned long>(threads, n);
+    if (chunks <= 1)
+    {
+        return duvalBoundaries(s, n);
+    }
+
+    vector<vector<IndexT>> factors(chunks);
+    parallelFor(0, chunks, chunks, [&](const unsigned long first, const unsigned long last)
+    {
+        for (unsigned long c = first; c < last; ++c)
+        {
+            const IndexT begin = n * c / chunks;
+            factors[c] = duvalBoundaries(s + begin, static_cast<IndexT>(n * (c + 1) / chunks - begin));
+            for (IndexT &boundary : factors[c])
+            {
+                boundary += begin;
+            }
+        }
+    });
+
+    // boundaries holds the starts of the factors found so far, the last one ends at end
+    vector<IndexT> boundaries;
+    IndexT end = 0;
+    for (const vector<IndexT> &chunk : factors)
+    {
+        unsigned long f = 0;
+        for (; f + 1 < chunk.size(); ++f)
+        {
+            boundaries.push_back(chunk[f]);
+            end = chunk[f + 1];
+            bool merged = false;
+            while (boundaries.size() >= 2)
+            {
+                const CharT *const previous = s + boundaries[boundaries.size() - 2];
+                const CharT *const top = s + boundaries.back();
+                if (!lexicographical_compare(previous, top, top, s + end))
+                {
+                    break;
+                }
+                boundaries.pop_back();
+                merged = true;
+            }
+            if (!merged)
+            {
+                break;
+            }
+        }
+        if (f + 1 < chunk.size())
+        {
+            boundaries.insert(boundaries.end(), chunk.begin() + f + 1, chunk.end() - 1);
+            end = chunk.back();
+        }
+    }
+    boundaries.push_back(n);
+    return boundaries;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,92 @@
+#ifndef EBWT_HPP
+#define EBWT_HPP
+
+// Extended Burrows-Wheeler transform of a multiset of words, described in:
+// "An extension of the Burrows-Wheeler Transform" (Mantaci, Restivo, Rosone, Sciortino)
+// the last symbols of the conjugates of all the words sorted in omega-order, with no separators between the words.
+// A word w = r^k contributes each conjugate of its primitive root r k times.
+
+#include <algorithm>
+#include <ostream>
+#include "duval.hpp"
+#include "leastRotation.hpp"
+#include "conjugates.hpp"
+#include "bwt.hpp"
+using namespace std;
+
+// the primitive roots of the words, each rotated to its least (Lyndon) rotation, and how many times it is repeated
+template<typename CharT, typename IndexT>
+struct PrimitiveRoots
+{
+    vector<CharT> text;
+    vector<IndexT> starts{0}; // the roots are text[starts[r], starts[r + 1])
+    vector<IndexT> exponents;
+    bool periodic = false; // if some exponent is greater than 1
+};
+
+// the least rotation of a periodic word is r^k with r Lyndon, so r is its first Lyndon factor
+template<typename CharT, typename IndexT>
+PrimitiveRoots<CharT, IndexT> primitiveRoots(const CharT *const text, const IndexT *const starts, const IndexT words)
+{
+    PrimitiveRoots<CharT, IndexT> roots;
+    roots.text.reserve(starts[words]);
+    vector<CharT> rotation;
+    for (IndexT w = 0; w < words; ++w)
+    {
+        const CharT *const word = text + starts[w];
+        const IndexT length = starts[w + 1] - starts[w];
+        if (length == 0)
+        {
+            continue;
+        }
+
+        rotation.resize(length);
+        rotate_copy(word, word + least_rotation(word, length), word + length, rotation.begin());
+        const IndexT root = firstLyndonFactorLength(rotation.data(), length);
+        roots.text.insert(roots.text.end(), rotation.begin(), rotation.begin() + root);
+        roots.starts.push_back(roots.text.size());
+        roots.exponents.push_back(length / root);
+        roots.periodic |= root != length;
+    }
+    return roots;
+}
+
+// SA is used as workspace, and must have room for the total length of the words
+template<typename CharT, typename IndexT, typename Output>
+void ebwt_core(const CharT *const text, const IndexT *const starts, const IndexT words, IndexT *const SA, const Output &output)
+{
+    const PrimitiveRoots<CharT, IndexT> roots = primitiveRoots(text, starts, words);
+    const IndexT length = roots.text.size();
+    const IndexT count = roots.exponents.size();
+    sortConjugates(roots.text.data(), roots.starts.data(), count, SA, length);
+
+    const CyclicWords<IndexT> cycles(roots.starts.data(), count, length);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        const CharT symbol = roots.text[cycles.prev(SA[i])];
+        const IndexT repetitions = roots.periodic ? roots.exponents[cycles.wordOf(SA[i])] : 1;
+        for (IndexT k = 0; k < repetitions; ++k)
+        {
+            output(symbol);
+        }
+    }
+}
+
+// the words are text[starts[w], starts[w + 1]), with starts[0] = 0 and starts[words] = total length;
+// output gets the total length symbols of the eBWT
+template<typename CharT, typename IndexT>
+void ebwt(const CharT *const text, const IndexT *const starts, const IndexT words, IndexT *const SA, CharT *const output)
+{
+    IndexT j = 0;
+    ebwt_core(text, starts, words, SA, [output, &j](const CharT symbol) { output[j++] = symbol; });
+}
+
+// same as ebwt, but the symbols are written to a binary stream
+template<typename CharT, typename IndexT>
+void writeEBWT(const CharT *const text, const IndexT *const starts, const IndexT words, IndexT *const SA, ostream &out, const unsigned long bytes_per_char = sizeof(CharT))
+{
+    SymbolWriter<CharT> writer(out, bytes_per_char);
+    ebwt_core(text, starts, words, SA, [&writer](const CharT symbol) { writer.put(symbol); });
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef GENERALIZED_SUFFIX_ARRAY_HPP
+#define GENERALIZED_SUFFIX_ARRAY_HPP
+
+// Generalized suffix array of a collection of documents, built in a single pass.
+// Each document is followed by its own separator, smaller than every byte and ordered by document,
+// so no suffix crosses the end of its document and equal suffixes are ordered by document.
+// The separators are virtual: they are not stored in the text, and cannot collide with any byte. Only SA-IS
+// reads them virtually, the in-place engine sorts a copy of the text with the separators stored in it.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "suffixArrayEngine.hpp"
+using namespace std;
+
+// the documents text[starts[d], starts[d + 1]) with separator d after each of them, seen as a single text
+// of length + documents symbols: separator d is symbol d, byte c is symbol documents + c
+template<typename IndexT>
+struct SeparatedText
+{
+    const uint8_t *text;
+    IndexT documents;
+    vector<uint64_t> separators; // bit i is set if position i of the separated text is a separator
+    vector<IndexT> before; // before[b] = number of separators in the blocks before b
+
+    SeparatedText(const uint8_t *const text, const IndexT *const starts, const IndexT documents)
+        : text(text), documents(documents), separators((starts[documents] + documents) / 64 + 1, 0), before(separators.size())
+    {
+        for (IndexT d = 0; d < documents; ++d)
+        {
+            const IndexT position = starts[d + 1] + d;
+            separators[position >> 6] |= 1ULL << (position & 63);
+        }
+        IndexT count = 0;
+        for (unsigned long b = 0; b < separators.size(); ++b)
+        {
+            before[b] = count;
+            count += __builtin_popcountll(separators[b]);
+        }
+    }
+
+    bool isSeparator(const IndexT i) const
+    {
+        return (separators[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // separators in [0, i), which is also the document containing i
+    IndexT separatorsBefore(const IndexT i) const
+    {
+        return before[i >> 6] + __builtin_popcountll(separators[i >> 6] & ((1ULL << (i & 63)) - 1));
+    }
+
+    IndexT operator()(const IndexT i) const
+    {
+        const IndexT previous = separatorsBefore(i);
+        return isSeparator(i) ? previous : documents + text[i - previous];
+    }
+};
+
+// SA gets the positions in text of the suffixes of all the documents text[starts[d], starts[d + 1]),
+// with starts[0] = 0 and starts[documents] = total length. SA must have room for length + documents entries.
+// SA-IS reads the separated text through SeparatedText, without storing it. The in-place engine needs a stored text,
+// so with it the separated text is copied with 16 or 32-bit symbols: 2 or 4 more bytes per position besides SA,
+// which makes this path a copying one, not an in-place one
+template<typename IndexT>
+void generalizedSuffixArray(const uint8_t *const text, const IndexT *const starts, const IndexT documents, IndexT *const SA, const SuffixArrayOptions &options = SuffixArrayOptions())
+{
+    const IndexT length = starts[documents];
+    const IndexT separated = length + documents;
+    if (separated == 0)
+    {
+        return;
+    }
+
+    const SeparatedText<IndexT> symbols(text, starts, documents);
+    const IndexT upper = documents + numeric_limits<uint8_t>::max();
+    const unsigned long saisBytes = saisWorkspaceBytes<uint8_t, IndexT>(separated) + 3 * (documents + 1) * sizeof(IndexT);
+    if (options.engine == SuffixArrayEngine::SAIS && (options.memory_budget == 0 || saisBytes <= options.memory_budget))
+    {
+        sais_core(symbols, SA, separated, upper);
+    }
+    else
+    {
+        // copying path: the separators are materialized next to the bytes
+        const auto sortCopy = [&](auto symbol_type)
+        {
+            vector<decltype(symbol_type)> stored(separated);
+            for (IndexT i = 0; i < separated; ++i)
+            {
+                stored[i] = symbols(i);
+            }
+            SuffixArrayOptions inplace = options;
+            inplace.engine = SuffixArrayEngine::InPlace;
+            computeSuffixArray(stored.data(), SA, separated, inplace);
+        };
+        if (upper <= numeric_limits<uint16_t>::max())
+        {
+            sortCopy(uint16_t());
+        }
+        else
+        {
+            sortCopy(uint32_t());
+        }
+    }
+
+    // the separators are the smallest suffixes, the others go back to positions in text
+    for (IndexT i = documents; i < separated; ++i)
+    {
+        SA[i - documents] = SA[i] - symbols.separatorsBefore(SA[i]);
+    }
+}
+
+// document containing position of the text
+template<typename IndexT>
+IndexT documentOf(const IndexT *const starts, const IndexT documents, const IndexT position)
+{
+    return upper_bound(starts, starts + documents + 1, position) - starts - 1;
+}
+
+#endif
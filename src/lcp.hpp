@@ -0,0 +1,118 @@
+#ifndef LCP_HPP
+#define LCP_HPP
+
+// LCP array from the suffix array, with the Phi algorithm described in:
+// "Permuted Longest-Common-Prefix Array" (Kärkkäinen, Manzini, Puglisi)
+// LCP[i] is the length of the longest common prefix of the suffixes SA[i-1] and SA[i], LCP[0] = 0
+
+#include <vector>
+#include "optimalSuffixArray.hpp"
+#include "parallel.hpp"
+using namespace std;
+
+// computes PLCP[first, last-1] (PLCP[i] = LCP of suffix i and the suffix preceding it in SA) over Phi,
+// where Phi[i] is the suffix preceding i in SA (length for the smallest one).
+// Each position is computed before being overwritten, and any range can be computed independently
+template<typename CharT, typename IndexT>
+void phiToPLCP(const CharT *const input, const IndexT length, IndexT *const phi, const IndexT first, const IndexT last)
+{
+    IndexT h = 0;
+    for (IndexT i = first; i < last; ++i)
+    {
+        const IndexT j = phi[i];
+        if (j == length)
+        {
+            h = 0;
+            phi[i] = 0;
+            continue;
+        }
+        while (i + h < length && j + h < length && input[i + h] == input[j + h])
+        {
+            ++h;
+        }
+        phi[i] = h;
+        if (h > 0)
+        {
+            --h;
+        }
+    }
+}
+
+// space-lean version: no memory besides LCP. PLCP is computed in LCP and then permuted in place
+// following the cycles of SA, visited positions are marked with the MSB of SA (restored at the end)
+template<typename CharT, typename IndexT>
+void lcpArray_inPlace(const CharT *const input, IndexT *const SA, const IndexT length, IndexT *const LCP)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    LCP[SA[0]] = length;
+    for (IndexT i = 1; i < length; ++i)
+    {
+        LCP[SA[i]] = SA[i - 1];
+    }
+    phiToPLCP(input, length, LCP, IndexT(0), length);
+
+    // LCP[i] = PLCP[SA[i]]
+    for (IndexT start = 0; start < length; ++start)
+    {
+        if (SA[start] & MSB<IndexT>)
+        {
+            continue;
+        }
+        const IndexT first_value = LCP[start];
+        IndexT j = start;
+        while (SA[j] != start)
+        {
+            LCP[j] = LCP[SA[j]];
+            const IndexT next = SA[j];
+            SA[j] |= MSB<IndexT>;
+            j = next;
+        }
+        LCP[j] = first_value;
+        SA[j] |= MSB<IndexT>;
+    }
+    for (IndexT i = 0; i < length; ++i)
+    {
+        SA[i] &= ~MSB<IndexT>;
+    }
+}
+
+// uses one more array of length words, but each phase runs on multiple threads
+template<typename CharT, typename IndexT>
+void lcpArray(const CharT *const input, const IndexT *const SA, const IndexT length, IndexT *const LCP, const unsigned threads = 1)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    vector<IndexT> PLCP(length);
+    IndexT *const phi = PLCP.data();
+    phi[SA[0]] = length;
+    parallelFor(1, length, threads, [SA, phi](const unsigned long first, const unsigned long last)
+    {
+        for (unsigned long i = first; i < last; ++i)
+        {
+            phi[SA[i]] = SA[i - 1];
+        }
+    });
+
+    // a chunk starting with h = 0 is still correct, it only gives up the head start from the previous position
+    parallelFor(0, length, threads, [input, length, phi](const unsigned long first, const unsigned long last)
+    {
+        phiToPLCP(input, length, phi, static_cast<IndexT>(first), static_cast<IndexT>(last));
+    });
+
+    parallelFor(0, length, threads, [SA, phi, LCP](const unsigned long first, const unsigned long last)
+    {
+        for (unsigned long i = first; i < last; ++i)
+        {
+            LCP[i] = phi[SA[i]];
+        }
+    });
+}
+
+#endif
@@ -32,4 +32,31 @@ unsigned long least_rotation(const T* const word, const unsigned long length){
     return k;
 }
 
+// O(1) space: the least rotation is the last Lyndon factor of word.word starting in the first half,
+// found with Duval's algorithm on the doubled word, without building it
+template<typename T>
+unsigned long least_rotation_lyndon(const T* const word, const unsigned long length){
+    const unsigned long n = 2*length;
+    unsigned long i = 0;
+    unsigned long least = 0;
+    while (i < length)
+    {
+        least = i;
+        unsigned long j = i + 1, k = i;
+        while (j < n && word[k % length] <= word[j % length])
+        {
+            if (word[k % length] < word[j % length])
+                k = i;
+            else
+                k++;
+            j++;
+        }
+        while (i <= k)
+        {
+            i += j - k;
+        }
+    }
+    return least;
+}
+
 #endif
\ No newline at end of file
@@ -10,8 +10,19 @@ struct Config {
     bool input_is_file = false;
     std::string input;
     std::string command;
+    std::string output;
+    std::vector<std::string> documents;
     size_t bytes_per_char = 1;
     size_t max_chars = 0; // 0 = unlimited
+    SuffixArrayOptions sa_options;
+    bool lcp = false;
+    unsigned threads = 1; // commands without the suffix array options
+    unsigned long sample_rate = 32;
+    std::string sampling = "sa";
+    bool direct_lyn = false;
+    std::vector<unsigned long> rotations;
+    std::string encoding = "varint";
+    std::string factorization_file;
 };
 
 int main(int argc, char** argv) {
@@ -21,9 +32,6 @@ int main(int argc, char** argv) {
     // Global flags
     bool quiet = false;
     app.add_flag("-q,--quiet", quiet, "Suppress verbose output");
-    if (quiet) {
-        config.verbose = false;
-    }
 
     app.description("This program is designed by Fabrizio Apuzzo as part of his Bachelor's Thesis at University of Naples Federico II.\n"
         "Clarity, simplicity and fidelity were prioritized over performance.");
@@ -31,10 +39,27 @@ int main(int argc, char** argv) {
     // Subcommands
     auto* conjugate = app.add_subcommand("conjugatefactors", "Find the factors of all conjugates of the input word");
     conjugate->add_option("word", config.input, "Input word")->required();
+    conjugate->add_option("--threads", config.threads, "Threads for the rank array, which then needs its own memory instead of replacing the suffix array. 0 = all cores")->check(CLI::NonNegativeNumber);
+    conjugate->add_flag("--direct-lyn", config.direct_lyn, "Compute the Lyndon array from the word alone, without the suffix array and the rank array");
     
+    auto* rotation = app.add_subcommand("rotationfactors", "Find the factors of single conjugates of the input word, after a linear preprocessing");
+    rotation->add_option("word", config.input, "Input word")->required();
+    rotation->add_option("--rotation", config.rotations, "Index where the conjugate starts, can be repeated. Default: all conjugates");
+    rotation->add_option("-o,--output", config.output, "Write Lyn, LynS and the least rotation to this binary file instead of printing the factors");
+    rotation->add_option("--encoding", config.encoding, "Numbers of the output file: varint (mostly one byte each) or fixed (4 or 8 bytes each)")->check(CLI::IsMember({"varint", "fixed"}));
+    rotation->add_option("--load", config.factorization_file, "Read the factors from a file written with --output for the same word, instead of computing them")->check(CLI::ExistingFile);
+
     auto* trees = app.add_subcommand("showtrees", "Show right and left Lyndon trees of the input word");
     trees->add_option("input", config.input, "Input word");
+    trees->add_option("--threads", config.threads, "Threads for the rank array, which then needs its own memory instead of replacing the suffix array. 0 = all cores")->check(CLI::NonNegativeNumber);
     
+    auto* factorization = app.add_subcommand("lyndonfactorization", "Print the starting positions of the Lyndon factors of the input word or file");
+    factorization->add_option("input", config.input, "Input word or filename")->required();
+    factorization->add_flag("--input-file", config.input_is_file, "Treat input as filename");
+    factorization->add_option("--bytes-per-char", config.bytes_per_char, "Bytes per character in file (upper bound depends on architecture)")->check(CLI::Range(1ul, sizeof(unsigned long)));
+    factorization->add_option("--max-chars", config.max_chars, "Max characters to read")->check(CLI::Range(0ul, numeric_limits<unsigned long>::max()));
+    factorization->add_option("--threads", config.threads, "Threads factorizing independent chunks of the input, 0 = all cores")->check(CLI::NonNegativeNumber);
+
     auto* suffix = app.add_subcommand("suffixarray", "Build suffix array of the input word or file");
     suffix->add_option("input", config.input, "Input word or filename")->required();
     suffix->add_flag("--input-file", config.input_is_file, "Treat input as filename");
@@ -42,41 +67,159 @@ int main(int argc, char** argv) {
     // these options are only relevant if input is a file
     suffix->add_option("--bytes-per-char", config.bytes_per_char, "Bytes per character in file (upper bound depends on architecture)")->check(CLI::Range(1ul, sizeof(unsigned long)));
     suffix->add_option("--max-chars", config.max_chars, "Max characters to read")->check(CLI::Range(0ul, numeric_limits<unsigned long>::max()));
+
+    // options of the suffix array construction, shared by the commands that build one
+    const map<string, SuffixArrayEngine> engines{{"inplace", SuffixArrayEngine::InPlace}, {"sais", SuffixArrayEngine::SAIS}};
+    const auto addSuffixArrayOptions = [&](CLI::App* command) {
+        command->add_option("--sa-engine", config.sa_options.engine, "Suffix array construction: inplace (O(1) workspace) or sais (faster, O(n) workspace)")->transform(CLI::CheckedTransformer(engines, CLI::ignore_case));
+        command->add_option("--memory-budget", config.sa_options.memory_budget, "Max workspace for the suffix array engine (e.g. 512MB), the in-place engine is used if exceeded. 0 = unlimited")->transform(CLI::AsSizeValue(false));
+        command->add_option("--scratch-budget", config.sa_options.scratch_budget, "Memory the in-place engine may use for linear time replacements of its O(n log n) steps (e.g. 64MB), such as the bucket boundaries of small alphabets. 0 = O(1) workspace")->transform(CLI::AsSizeValue(false));
+        command->add_flag("--fast", config.sa_options.performance_mode, "Let the in-place engine use faster variants of its steps, instead of following the paper literally");
+        command->add_option("--threads", config.sa_options.threads, "Threads used by the in-place engine and the LCP construction, 0 = all cores")->check(CLI::NonNegativeNumber);
+    };
+    addSuffixArrayOptions(suffix);
+    suffix->add_flag("--lcp", config.lcp, "Also print the LCP array (longest common prefix of adjacent suffixes)");
     
+    auto* conjugate_array = app.add_subcommand("conjugatearray", "Build the conjugate array (rotations sorted lexicographically) of the input word or file");
+    conjugate_array->add_option("input", config.input, "Input word or filename")->required();
+    conjugate_array->add_flag("--input-file", config.input_is_file, "Treat input as filename");
+    conjugate_array->add_option("--bytes-per-char", config.bytes_per_char, "Bytes per character in file (upper bound depends on architecture)")->check(CLI::Range(1ul, sizeof(unsigned long)));
+    conjugate_array->add_option("--max-chars", config.max_chars, "Max characters to read")->check(CLI::Range(0ul, numeric_limits<unsigned long>::max()));
+    addSuffixArrayOptions(conjugate_array);
+
+    auto* sampled = app.add_subcommand("sampledsa", "Build a suffix array keeping one entry every --rate, for locate-style indexes");
+    sampled->add_option("input", config.input, "Input word or filename")->required();
+    sampled->add_flag("--input-file", config.input_is_file, "Treat input as filename");
+    sampled->add_option("--bytes-per-char", config.bytes_per_char, "Bytes per character in file (upper bound depends on architecture)")->check(CLI::Range(1ul, sizeof(unsigned long)));
+    sampled->add_option("--max-chars", config.max_chars, "Max characters to read")->check(CLI::Range(0ul, numeric_limits<unsigned long>::max()));
+    sampled->add_option("--rate", config.sample_rate, "Sampling rate")->check(CLI::PositiveNumber);
+    sampled->add_option("--sampling", config.sampling, "sa: every rate-th row, text: the suffixes at positions multiple of rate and their rows, "
+        "sparse: the suffixes at positions multiple of rate, sorted without building the full suffix array")->check(CLI::IsMember({"sa", "text", "sparse"}));
+    addSuffixArrayOptions(sampled);
+
+    // input and output of the commands writing a transform of the input to a binary file
+    const auto addTransformOptions = [&](CLI::App* command) {
+        command->add_option("input", config.input, "Input word or filename")->required();
+        command->add_flag("--input-file", config.input_is_file, "Treat input as filename");
+        command->add_option("-o,--output", config.output, "Output file, each character is written with --bytes-per-char bytes")->required();
+        command->add_option("--bytes-per-char", config.bytes_per_char, "Bytes per character in file (upper bound depends on architecture)")->check(CLI::Range(1ul, sizeof(unsigned long)));
+        command->add_option("--max-chars", config.max_chars, "Max characters to read")->check(CLI::Range(0ul, numeric_limits<unsigned long>::max()));
+    };
+
+    auto* bwt_command = app.add_subcommand("bwt", "Write the Burrows-Wheeler transform of the input word or file to a binary file");
+    addTransformOptions(bwt_command);
+    addSuffixArrayOptions(bwt_command);
+
+    auto* bbwt_command = app.add_subcommand("bbwt", "Write the bijective Burrows-Wheeler transform of the input word or file to a binary file");
+    addTransformOptions(bbwt_command);
+
+    auto* unbbwt_command = app.add_subcommand("unbbwt", "Write the text whose bijective Burrows-Wheeler transform is the input word or file to a binary file");
+    addTransformOptions(unbbwt_command);
+    unbbwt_command->add_option("--threads", config.threads, "Threads decoding independent cycles, 0 = all cores")->check(CLI::NonNegativeNumber);
+
+    auto* ebwt_command = app.add_subcommand("ebwt", "Write the extended Burrows-Wheeler transform of the words of a file (one per line) to a binary file");
+    ebwt_command->add_option("input", config.input, "Input filename")->required()->check(CLI::ExistingFile);
+    ebwt_command->add_option("-o,--output", config.output, "Output file")->required();
+
+    auto* gsa_command = app.add_subcommand("gsa", "Build the generalized suffix array of the given files, as (document, offset) pairs");
+    gsa_command->add_option("files", config.documents, "Input filenames, document i is the i-th one")->required()->check(CLI::ExistingFile);
+    addSuffixArrayOptions(gsa_command);
+
     auto* test = app.add_subcommand("test", "Run tests");
     
     CLI11_PARSE(app, argc, argv);
+    if (quiet) {
+        config.verbose = false;
+    }
+    config.sa_options.threads = resolveThreads(config.sa_options.threads);
+    config.threads = resolveThreads(config.threads);
     
     const char* const word = config.input.c_str();
     const unsigned long length = config.input.length();
 
+    // calls run(input, size, bytes_per_char) with the input word, or with the content of the input file
+    // read into the narrowest symbol type that holds --bytes-per-char bytes
+    const auto withInput = [&](const auto& run) {
+        if (!config.input_is_file) {
+            run(word, length, sizeof(char));
+            return;
+        }
+        unsigned long size;
+        const auto runOnFile = [&](const auto* const file_content) {
+            if (file_content) {
+                run(file_content, size, config.bytes_per_char);
+                delete[] file_content;
+            }
+        };
+        if (config.bytes_per_char == sizeof(char)) {
+            runOnFile(readFile(config.input, config.max_chars > 0 ? config.max_chars : numeric_limits<unsigned long>::max(), size));
+        } else if (config.bytes_per_char == sizeof(uint16_t)) {
+            runOnFile(readSymbols<uint16_t>(config.input, config.bytes_per_char, config.max_chars, size));
+        } else if (config.bytes_per_char <= sizeof(uint32_t)) {
+            runOnFile(readSymbols<uint32_t>(config.input, config.bytes_per_char, config.max_chars, size));
+        } else {
+            runOnFile(readSymbols<unsigned long>(config.input, config.bytes_per_char, config.max_chars, size));
+        }
+    };
+
     // Execute based on subcommand
     if (*conjugate) {
-        PrintAllFactors(word, config.verbose);
+        PrintAllFactors(word, config.verbose, config.threads, config.direct_lyn);
+    }
+    else if (*rotation) {
+        if (!config.output.empty()) {
+            saveRotationFactors(word, length, config.output, config.encoding, config.verbose);
+        }
+        else {
+            rotationFactors(word, length, config.rotations, config.verbose, config.factorization_file);
+        }
     }
     else if (*trees) {
-        showTrees(word, config.verbose);
+        showTrees(word, config.verbose, config.threads);
     }
     else if (*test) {
         testAll();
     }
+    else if (*factorization) {
+        withInput([&](const auto* const input, const unsigned long size, unsigned long) {
+            lyndonFactorization(input, size, config.verbose, config.threads);
+        });
+    }
     else if (*suffix) {
-        if (config.input_is_file) {
-            unsigned long size;
-            unsigned long* file_content = readFile(config.input, config.bytes_per_char, config.max_chars, size);
-            if (file_content) {
-                if (config.bytes_per_char == sizeof(char)) {
-                    char* char_content = reinterpret_cast<char*>(file_content);
-                    suffixArray(char_content, size, config.verbose);
-                    delete[] char_content;
-                } else {
-                    suffixArray(file_content, size, config.verbose);
-                }
-                delete[] file_content;
-            }
-        } else {
-            suffixArray(word, length, config.verbose);
-        }
+        withInput([&](const auto* const input, const unsigned long size, unsigned long) {
+            suffixArray(input, size, config.verbose, config.sa_options, config.lcp);
+        });
+    }
+    else if (*conjugate_array) {
+        withInput([&](const auto* const input, const unsigned long size, unsigned long) {
+            conjugateArray(input, size, config.verbose, config.sa_options);
+        });
+    }
+    else if (*sampled) {
+        withInput([&](const auto* const input, const unsigned long size, unsigned long) {
+            sampledSuffixArray(input, size, config.sample_rate, config.sampling, config.verbose, config.sa_options);
+        });
+    }
+    else if (*bwt_command) {
+        withInput([&](const auto* const input, const unsigned long size, const unsigned long bytes_per_char) {
+            bwt(input, size, config.output, bytes_per_char, config.verbose, config.sa_options);
+        });
+    }
+    else if (*bbwt_command) {
+        withInput([&](const auto* const input, const unsigned long size, const unsigned long bytes_per_char) {
+            bijectiveBWT(input, size, config.output, bytes_per_char, config.verbose);
+        });
+    }
+    else if (*unbbwt_command) {
+        withInput([&](const auto* const input, const unsigned long size, const unsigned long bytes_per_char) {
+            inverseBijectiveBWT(input, size, config.output, bytes_per_char, config.verbose, config.threads);
+        });
+    }
+    else if (*ebwt_command) {
+        extendedBWT(config.input, config.output, config.verbose);
+    }
+    else if (*gsa_command) {
+        corpusSuffixArray(config.documents, config.verbose, config.sa_options);
     }
     else if (app.get_subcommands().size() > 0 && *(app.get_subcommands()[0]) ) {
         testAll();
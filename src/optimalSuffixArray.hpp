@@ -1,3 +1,6 @@
+#ifndef OPTIMAL_SUFFIX_ARRAY_HPP
+#define OPTIMAL_SUFFIX_ARRAY_HPP
+
 // Computation of the suffix array of read-only general alphabets is described in:
 // "Optimal in-place suffix array construction"
 
@@ -5,16 +8,125 @@
 #include <iostream>
 #include <limits>
 #include <climits>
+#include <cstdint>
+#include <vector>
+#include "parallel.hpp"
 using namespace std;
 
-#define BT -1UL
-#define BH -2UL
-#define E -3UL
-#define R1 -4UL
-#define R2 -5UL
-#define MAX_CHAR -6UL
+// special symbols used by induced sorting (section 5.5), they are the largest values
+// representable by the index type, so they never collide with an index of SA
+template<typename IndexT> constexpr IndexT BT = numeric_limits<IndexT>::max();
+template<typename IndexT> constexpr IndexT BH = numeric_limits<IndexT>::max() - 1;
+template<typename IndexT> constexpr IndexT E = numeric_limits<IndexT>::max() - 2;
+template<typename IndexT> constexpr IndexT R1 = numeric_limits<IndexT>::max() - 3;
+template<typename IndexT> constexpr IndexT R2 = numeric_limits<IndexT>::max() - 4;
+template<typename IndexT> constexpr IndexT MAX_CHAR = numeric_limits<IndexT>::max() - 5;
+
+// used to mark positions of SA during the iterative recursion, so indices must fit in the other bits
+template<typename IndexT> constexpr IndexT MSB = IndexT(1) << (numeric_limits<IndexT>::digits - 1);
+
+// largest length that can be sorted using IndexT as the type of the suffix array
+template<typename IndexT>
+constexpr unsigned long maxLengthFor()
+{
+    return static_cast<unsigned long>(MSB<IndexT>) - 1;
+}
+
+// L/S types of the suffixes of one level, packed: bit i is set if suffix i is L-type
+struct TypeBits
+{
+    unsigned long length = 0;
+    unsigned long nS = 0; // number of S-type suffixes
+    vector<uint64_t> words;
 
-constexpr unsigned long MSB = 1UL << (numeric_limits<unsigned long>::digits - 1);
+    bool isL(const unsigned long i) const
+    {
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    // first index after start with the requested type, length if there is none
+    unsigned long next(const unsigned long start, const bool wantL) const
+    {
+        const unsigned long i = start + 1;
+        if (i >= length)
+        {
+            return length;
+        }
+        unsigned long w = i >> 6;
+        uint64_t word = (wantL ? words[w] : ~words[w]) & (~0ULL << (i & 63));
+        while (word == 0)
+        {
+            if (++w == words.size())
+            {
+                return length;
+            }
+            word = wantL ? words[w] : ~words[w];
+        }
+        return min(length, (w << 6) + __builtin_ctzll(word));
+    }
+};
+
+// state of one call of optimalSuffixArray: nothing is shared between calls, so that
+// independent suffix arrays can be built concurrently, each with its own context
+template<typename IndexT>
+struct SuffixArrayContext
+{
+    // see case4 and case4_S
+    IndexT case4_L_cached_l = numeric_limits<IndexT>::max();
+    IndexT case4_S_cached_l = numeric_limits<IndexT>::max();
+
+    // statistics
+    unsigned long levels = 0; // recursion levels processed
+    unsigned long case4_calls = 0;
+    unsigned long case4_cache_hits = 0;
+
+    // threads used by the parallel steps, 1 keeps the O(1) workspace of the paper
+    unsigned threads = 1;
+
+    // trades fidelity to the paper for speed in steps that need no extra memory
+    bool performance_mode = false;
+
+    // bytes that the optional linear time steps may allocate, 0 keeps the O(1) workspace of the paper
+    unsigned long scratch_budget = 0;
+    vector<IndexT> scratch;
+
+    // types of the levels waiting for their second half (a stack, the deepest level is on top),
+    // only levels whose types fit the scratch budget are present
+    vector<TypeBits> level_types;
+    unsigned long type_bytes = 0;
+
+    // bucket index of the current level, see buildBucketIndex
+    bool has_bucket_index = false;
+    unsigned long bucket_offset = 0; // smallest symbol of the level
+    vector<IndexT> bucket_heads;     // bucket_heads[c - bucket_offset] is the head of bucket c in SA
+    vector<IndexT> bucket_fill;      // see preprocess_buckets
+
+    void reset_case4_caches()
+    {
+        case4_L_cached_l = numeric_limits<IndexT>::max();
+        case4_S_cached_l = numeric_limits<IndexT>::max();
+    }
+
+    // memory held by the bucket index, charged to the scratch budget
+    unsigned long bucket_bytes() const
+    {
+        return (bucket_heads.capacity() + bucket_fill.capacity()) * sizeof(IndexT);
+    }
+
+    // returns room for count elements, or nullptr if it does not fit the scratch budget
+    IndexT *getScratch(const unsigned long count)
+    {
+        if (count * sizeof(IndexT) + type_bytes + bucket_bytes() > scratch_budget)
+        {
+            return nullptr;
+        }
+        if (scratch.size() < count)
+        {
+            scratch.resize(count);
+        }
+        return scratch.data();
+    }
+};
 
 
 // ----- auxiliary functions
@@ -27,6 +139,15 @@ void char_to_ulong_array(const char *const input_chars, unsigned long *const out
     }
 }
 
+template<typename IndexT>
+void char_to_index_array(const char *const input_chars, IndexT *const output, const IndexT length)
+{
+    for (IndexT i = 0; i < length; ++i)
+    {
+        output[i] = static_cast<IndexT>(static_cast<unsigned char>(input_chars[i]));
+    }
+}
+
 /* obtains the last index of substrings from observation 2 from the paper:
     For any index i of T, let j ∈[i +1, n −1] be the smallest index such that T[j] < T[j +1] (So T[j] is S-type).
     Furthermore let k ∈[i + 1, j] be the smallest index such that T[l] = T[j] for any k ≤ l ≤ j. Then T[k] is the first S-type
@@ -35,9 +156,15 @@ void char_to_ulong_array(const char *const input_chars, unsigned long *const out
 
     also see https://pdf.sciencedirectassets.com/272975/1-s2.0-S1570866705X00090/1-s2.0-S1570866704000498/main.pdf
 */
-unsigned long getS_SubstringEnd(const unsigned long *const input, const unsigned long start, const unsigned long length)
+template<typename CharT, typename IndexT>
+IndexT getS_SubstringEnd(const CharT *const input, const IndexT start, const IndexT length, const TypeBits *const types = nullptr)
 {
-    unsigned long j = start + 1;
+    if (types)
+    {
+        return types->next(start, false);
+    }
+
+    IndexT j = start + 1;
 
     // find j
     while (j < length - 1 && input[j] >= input[j + 1])
@@ -48,7 +175,7 @@ unsigned long getS_SubstringEnd(const unsigned long *const input, const unsigned
         return length; // sentinel
 
     // find k
-    unsigned long k = j;
+    IndexT k = j;
 
     while (k > start && input[k] == input[j])
     {
@@ -59,9 +186,15 @@ unsigned long getS_SubstringEnd(const unsigned long *const input, const unsigned
 }
 
 // assumed
-unsigned long getL_SubstringEnd(const unsigned long *const input, const unsigned long start, const unsigned long length)
+template<typename CharT, typename IndexT>
+IndexT getL_SubstringEnd(const CharT *const input, const IndexT start, const IndexT length, const TypeBits *const types = nullptr)
 {
-    unsigned long j = start + 1;
+    if (types)
+    {
+        return types->next(start, true);
+    }
+
+    IndexT j = start + 1;
 
     // find j
     while (j < length - 1 && input[j] <= input[j + 1])
@@ -70,7 +203,7 @@ unsigned long getL_SubstringEnd(const unsigned long *const input, const unsigned
     }
 
     // find k
-    unsigned long k = j - 1;
+    IndexT k = j - 1;
 
     while (k > start && input[k] == input[j])
     {
@@ -80,18 +213,19 @@ unsigned long getL_SubstringEnd(const unsigned long *const input, const unsigned
     return k+1;
 }
 
-int compare_substrings(const unsigned long *const input, unsigned long offsetA, unsigned long offsetB, const unsigned long length, const bool usingLType)
+template<typename CharT, typename IndexT>
+int compare_substrings(const CharT *const input, IndexT offsetA, IndexT offsetB, const IndexT length, const bool usingLType, const TypeBits *const types = nullptr)
 {
-    unsigned long endA, endB;
+    IndexT endA, endB;
     if (usingLType)
     {
-        endA = getL_SubstringEnd(input, offsetA, length);
-        endB = getL_SubstringEnd(input, offsetB, length);
+        endA = getL_SubstringEnd(input, offsetA, length, types);
+        endB = getL_SubstringEnd(input, offsetB, length, types);
     }
     else
     {
-        endA = getS_SubstringEnd(input, offsetA, length);
-        endB = getS_SubstringEnd(input, offsetB, length);
+        endA = getS_SubstringEnd(input, offsetA, length, types);
+        endB = getS_SubstringEnd(input, offsetB, length, types);
     }
 
 
@@ -154,13 +288,14 @@ int compare_substrings(const unsigned long *const input, unsigned long offsetA,
     }
 }
 
-void Heapify(unsigned long *const SA, unsigned long *const array, const unsigned long length, unsigned long index)
+template<typename IndexT>
+void Heapify(IndexT *const SA, IndexT *const array, const IndexT length, IndexT index)
 {
     while (true)
     {
-        unsigned long biggest = index;
-        const unsigned long left = 2 * index + 1;
-        const unsigned long right = 2 * index + 2;
+        IndexT biggest = index;
+        const IndexT left = 2 * index + 1;
+        const IndexT right = 2 * index + 2;
         if (left < length && array[left] > array[biggest])
         {
             biggest = left;
@@ -182,28 +317,30 @@ void Heapify(unsigned long *const SA, unsigned long *const array, const unsigned
     }
 }
 
-void BuildHeap(unsigned long *const SA, const unsigned long length, const unsigned long nS)
+template<typename IndexT>
+void BuildHeap(IndexT *const SA, const IndexT length, const IndexT nS)
 {
-    for (unsigned long i = nS / 2; i > 0; --i)
+    for (IndexT i = nS / 2; i > 0; --i)
     {
-        const unsigned long index = i - 1;
+        const IndexT index = i - 1;
         Heapify(SA, SA + length - nS, nS, index);
     }
 }
 
 // modified binary search that returns the first occurrence of the value
-unsigned long custom_binary_search(const unsigned long *const input, const unsigned long * const array, const unsigned long length, const unsigned long value, const bool usingLType)
+template<typename CharT, typename IndexT>
+IndexT custom_binary_search(const CharT *const input, const IndexT * const array, const IndexT length, const CharT value, const bool usingLType)
 {
-    unsigned long left = 0;
-    unsigned long right = length - 1;
+    IndexT left = 0;
+    IndexT right = length - 1;
 
-    const auto is_valid = [array, length, usingLType](unsigned long index)
-    { return array[index] < length && (usingLType || index == 0 || array[index - 1] != BH) && (!usingLType || index == length - 1 || array[index + 1] != BH); };
+    const auto is_valid = [array, length, usingLType](IndexT index)
+    { return array[index] < length && (usingLType || index == 0 || array[index - 1] != BH<IndexT>) && (!usingLType || index == length - 1 || array[index + 1] != BH<IndexT>); };
 
     while (right > left)
     {
-        const unsigned long mid = left + ((right - left) / 2);
-        unsigned long checking = mid;
+        const IndexT mid = left + ((right - left) / 2);
+        IndexT checking = mid;
         while (checking > left && !is_valid(checking)) // 3 iterations at most
         {
             --checking;
@@ -223,18 +360,19 @@ unsigned long custom_binary_search(const unsigned long *const input, const unsig
     return left;
 }
 
-unsigned long custom_binary_search_last(const unsigned long *const input, const unsigned long *const array, const unsigned long length, const unsigned long value)
+template<typename CharT, typename IndexT>
+IndexT custom_binary_search_last(const CharT *const input, const IndexT *const array, const IndexT length, const CharT value)
 {
-    unsigned long left = 0;
-    unsigned long right = length - 1;
+    IndexT left = 0;
+    IndexT right = length - 1;
 
-    const auto is_valid = [array, length](const unsigned long index)
-    { return (array[index] < length) && (index == length - 1 || array[index + 1] != BH); };
+    const auto is_valid = [array, length](const IndexT index)
+    { return (array[index] < length) && (index == length - 1 || array[index + 1] != BH<IndexT>); };
 
     while (right > left)
     {
-        const unsigned long mid = left + (right - left) / 2 + ((right - left) % 2);
-        unsigned long checking = mid;
+        const IndexT mid = left + (right - left) / 2 + ((right - left) % 2);
+        IndexT checking = mid;
         while (checking < right && !is_valid(checking)) // 3 iterations at most
         {
             ++checking;
@@ -253,18 +391,68 @@ unsigned long custom_binary_search_last(const unsigned long *const input, const
         return length;
     return right;
 }
-// end of auxiliary functions -----
+// counts the symbols of the level, so that the head and tail of each bucket of the sorted SA
+// are known in O(1) instead of searching them. The heads and the fills of preprocess_buckets take
+// 2 * (symbols + 1) words of the scratch budget: without room for them, the index is skipped and released
+template<typename CharT, typename IndexT>
+void buildBucketIndex(const CharT *const input, const IndexT length, SuffixArrayContext<IndexT> &context)
+{
+    context.has_bucket_index = false;
+    const auto range = minmax_element(input, input + length);
+    const unsigned long symbols = static_cast<unsigned long>(*range.second - *range.first) + 1;
+    const unsigned long available = context.scratch_budget - min(context.scratch_budget, context.type_bytes + context.scratch.size() * sizeof(IndexT));
+    if (symbols == 0 || symbols >= available / sizeof(IndexT) / 2)
+    {
+        vector<IndexT>().swap(context.bucket_heads);
+        vector<IndexT>().swap(context.bucket_fill);
+        return;
+    }
 
-void optimalSuffixArray(const unsigned long *const input, unsigned long *const SA, const unsigned long length);
+    context.bucket_offset = *range.first;
+    context.bucket_heads.assign(symbols + 1, 0);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        ++context.bucket_heads[input[i] - context.bucket_offset + 1];
+    }
+    for (unsigned long c = 1; c <= symbols; ++c)
+    {
+        context.bucket_heads[c] += context.bucket_heads[c - 1];
+    }
+    context.has_bucket_index = true;
+}
+
+// first index of the bucket of value in SA
+template<typename CharT, typename IndexT>
+IndexT bucketHead(const CharT *const input, const IndexT *const SA, const IndexT length, const CharT value, const bool usingLType, const SuffixArrayContext<IndexT> &context)
+{
+    if (context.has_bucket_index)
+    {
+        return context.bucket_heads[value - context.bucket_offset];
+    }
+    return custom_binary_search(input, SA, length, value, usingLType);
+}
+
+// last index of the bucket of value in SA
+template<typename CharT, typename IndexT>
+IndexT bucketTail(const CharT *const input, const IndexT *const SA, const IndexT length, const CharT value, const SuffixArrayContext<IndexT> &context)
+{
+    if (context.has_bucket_index)
+    {
+        return context.bucket_heads[value - context.bucket_offset + 1] - 1;
+    }
+    return custom_binary_search_last(input, SA, length, value);
+}
+// end of auxiliary functions -----
 
-unsigned long countS_Type(const unsigned long *const input, const unsigned long length)
+template<typename CharT, typename IndexT>
+IndexT countS_Type(const CharT *const input, const IndexT length)
 {
     bool nextIsL = true;
-    unsigned long count = 0;
-    unsigned long last_inserted_index = length;
-    for (unsigned long i = 0; i < length - 1; ++i)
+    IndexT count = 0;
+    IndexT last_inserted_index = length;
+    for (IndexT i = 0; i < length - 1; ++i)
     {
-        const unsigned long index = length - i - 2;
+        const IndexT index = length - i - 2;
         const bool currentIsL = input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]);
         if (!currentIsL)
         {
@@ -275,17 +463,77 @@ unsigned long countS_Type(const unsigned long *const input, const unsigned long
     return count;
 }
 
+// computes the types of the level in one right to left scan and pushes them on the stack of the context,
+// so that the other steps of both halves of the level do not scan the input again.
+// returns nullptr (and computes nothing) if they do not fit the scratch budget
+template<typename CharT, typename IndexT>
+const TypeBits *buildTypes(const CharT *const input, const IndexT length, SuffixArrayContext<IndexT> &context)
+{
+    const unsigned long words = (static_cast<unsigned long>(length) + 63) / 64;
+    const unsigned long bytes = words * sizeof(uint64_t);
+    if (context.type_bytes + bytes + context.scratch.size() * sizeof(IndexT) + context.bucket_bytes() > context.scratch_budget)
+    {
+        return nullptr;
+    }
+
+    context.level_types.emplace_back();
+    TypeBits &types = context.level_types.back();
+    types.length = length;
+    types.words.assign(words, 0);
+    context.type_bytes += bytes;
+
+    bool nextIsL = true;
+    types.words[(length - 1) >> 6] |= 1ULL << ((length - 1) & 63);
+    for (IndexT index = length - 1; index > 0; --index)
+    {
+        const IndexT i = index - 1;
+        const bool currentIsL = input[i] > input[i + 1] || (nextIsL && input[i] == input[i + 1]);
+        if (currentIsL)
+        {
+            types.words[i >> 6] |= 1ULL << (i & 63);
+        }
+        else
+        {
+            ++types.nS;
+        }
+        nextIsL = currentIsL;
+    }
+    return &types;
+}
+
+// types of the level computed by buildTypes in the first half, if any
+template<typename IndexT>
+const TypeBits *currentTypes(const IndexT length, const SuffixArrayContext<IndexT> &context)
+{
+    if (!context.level_types.empty() && context.level_types.back().length == length)
+    {
+        return &context.level_types.back();
+    }
+    return nullptr;
+}
+
+template<typename IndexT>
+void releaseTypes(const IndexT length, SuffixArrayContext<IndexT> &context)
+{
+    if (currentTypes(length, context))
+    {
+        context.type_bytes -= context.level_types.back().words.size() * sizeof(uint64_t);
+        context.level_types.pop_back();
+    }
+}
+
 // section 5.2 - step 1
 // find S suffixes and put indexes in SA[length-nS, length-1]
 // returns the number of S-type suffixes found (nS)
-void placeIndicesOf_Type(const unsigned long *const input, const unsigned long length, unsigned long * const SA, const bool usingLType)
+template<typename CharT, typename IndexT>
+void placeIndicesOf_Type(const CharT *const input, const IndexT length, IndexT * const SA, const bool usingLType, const TypeBits *const types = nullptr)
 {
     bool nextIsL = false; // the sentinel at the end is S_TYPE
-    unsigned long last_inserted_index = length;
-    for (unsigned long i = 0; i < length; ++i)
+    IndexT last_inserted_index = length;
+    for (IndexT i = 0; i < length; ++i)
     {
-        const unsigned long index = length - i - 1;
-        const bool currentIsL = (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
+        const IndexT index = length - i - 1;
+        const bool currentIsL = types ? types->isL(index) : (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
         if ((currentIsL && usingLType) || (!currentIsL && !usingLType))
         {
             SA[--last_inserted_index] = index;
@@ -294,30 +542,149 @@ void placeIndicesOf_Type(const unsigned long *const input, const unsigned long l
     }
 }
 
+constexpr unsigned long INSERTION_SORT_RUN = 8;
+
+// merge sort of runs[0, n-1] for the performance mode of mergeSort_Substrings, buffer[0, n-1] must not overlap runs.
+// the passes alternate the direction of the merge (ping-pong), the sorted result ends up in runs
+template<typename IndexT, typename Compare>
+void mergeSort_Substrings_buffered(IndexT *const runs, IndexT *const buffer, const IndexT n, const unsigned threads, const Compare &compare)
+{
+    const unsigned long blocks = (static_cast<unsigned long>(n) + INSERTION_SORT_RUN - 1) / INSERTION_SORT_RUN;
+    parallelFor(0, blocks, max(threads, 1u), [&](const unsigned long first, const unsigned long last)
+    {
+        for (unsigned long b = first; b < last; ++b)
+        {
+            IndexT * const begin = runs + b * INSERTION_SORT_RUN;
+            IndexT * const end = runs + min<unsigned long>((b + 1) * INSERTION_SORT_RUN, n);
+            for (IndexT *current = begin + 1; current < end; ++current)
+            {
+                const IndexT value = *current;
+                IndexT *position = current;
+                while (position > begin && compare(value, *(position - 1)))
+                {
+                    *position = *(position - 1);
+                    --position;
+                }
+                *position = value;
+            }
+        }
+    });
+
+    IndexT *from = runs;
+    IndexT *to = buffer;
+    for (unsigned long step = INSERTION_SORT_RUN; step < n; step *= 2)
+    {
+        // the last run may have no partner, it is merged with an empty run (i.e. copied)
+        const unsigned long merges = (n + step * 2 - 1) / (step * 2);
+        if (merges >= threads)
+        {
+            parallelFor(0, merges, threads, [&](const unsigned long first, const unsigned long last)
+            {
+                for (unsigned long k = first; k < last; ++k)
+                {
+                    const unsigned long i = k * step * 2;
+                    const unsigned long mid = min<unsigned long>(i + step, n);
+                    const unsigned long end = min<unsigned long>(i + step * 2, n);
+                    merge(from + i, from + mid, from + mid, from + end, to + i, compare);
+                }
+            });
+        }
+        else
+        {
+            for (unsigned long k = 0; k < merges; ++k)
+            {
+                const unsigned long i = k * step * 2;
+                const unsigned long mid = min<unsigned long>(i + step, n);
+                const unsigned long end = min<unsigned long>(i + step * 2, n);
+                parallelMerge(from + i, mid - i, from + mid, end - mid, to + i, threads, compare);
+            }
+        }
+        swap(from, to);
+    }
+
+    if (from != runs)
+    {
+        parallelFor(0, n, max(threads, 1u), [from, runs](const unsigned long first, const unsigned long last)
+        {
+            copy(from + first, from + last, runs + first);
+        });
+    }
+}
+
 // section 5.2 - step 2
 // sorts the S-type suffixes in SA[length-nS, length-1] using merge sort
 // the comparison function compares suffixes by their lexicographic order
 // according to this ordering, a word is always bigger than its prefixes
-void mergeSort_Substrings(const unsigned long *const input, const unsigned long length, unsigned long *const SA, const unsigned long nS, const bool usingLType)
+// with threads > 1 the merges of each pass run concurrently, and the last passes (with fewer
+// merges than threads) split each merge along the merge path, still using only SA[0, nS-1] as buffer
+// with buffered = true (performance mode) small runs are insertion sorted first, and each pass merges
+// from one region to the other alternately instead of merging into SA[0, nS-1] and moving back
+template<typename CharT, typename IndexT>
+void mergeSort_Substrings(const CharT *const input, const IndexT length, IndexT *const SA, const IndexT nS, const bool usingLType, const unsigned threads = 1, const TypeBits *const types = nullptr, const bool buffered = false)
 {
     // merge sort SA[nS, length-1] using SA[0, nS-1] as the auxiliary array, thus O(1) space
 
-    const auto compare = [input, length, usingLType](const unsigned long &a, const unsigned long &b)
+    const auto compare = [input, length, usingLType, types](const IndexT &a, const IndexT &b)
     {
-        return compare_substrings(input, a, b, length, usingLType) < 0;
+        return compare_substrings(input, a, b, length, usingLType, types) < 0;
     };
 
-    unsigned long step = 1;
-    while (step < length)
+    if (buffered)
     {
-        for (unsigned long i = length - nS; i < length - step; i += step * 2)
+        mergeSort_Substrings_buffered(SA + length - nS, SA, nS, threads, compare);
+        return;
+    }
+
+    if (threads <= 1)
+    {
+        IndexT step = 1;
+        while (step < length)
         {
-            const unsigned long mid = i + step;
-            const unsigned long end = min(i + step * 2, length);
-            merge(SA + i, SA + mid, SA + mid, SA + end, SA, compare);
-            move(SA, SA + end - i, SA + i); // inefficient but fidelity to the paper
+            for (IndexT i = length - nS; i < length - step; i += step * 2)
+            {
+                const IndexT mid = i + step;
+                const IndexT end = min(i + step * 2, length);
+                merge(SA + i, SA + mid, SA + mid, SA + end, SA, compare);
+                move(SA, SA + end - i, SA + i); // inefficient but fidelity to the paper
+            }
+            step *= 2;
+        }
+        return;
+    }
+
+    // each run is merged into the same offset of SA[0, nS-1] (free, since nS <= length - nS), so merges do not overlap
+    const IndexT base = length - nS;
+    for (IndexT step = 1; step < nS; step *= 2)
+    {
+        const IndexT merges = (nS - step + step * 2 - 1) / (step * 2);
+        if (merges >= threads)
+        {
+            parallelFor(0, merges, threads, [&](const unsigned long first, const unsigned long last)
+            {
+                for (unsigned long k = first; k < last; ++k)
+                {
+                    const IndexT i = base + k * step * 2;
+                    const IndexT mid = i + step;
+                    const IndexT end = min(i + step * 2, length);
+                    merge(SA + i, SA + mid, SA + mid, SA + end, SA + i - base, compare);
+                    move(SA + i - base, SA + end - base, SA + i);
+                }
+            });
+        }
+        else
+        {
+            for (IndexT k = 0; k < merges; ++k)
+            {
+                const IndexT i = base + k * step * 2;
+                const IndexT mid = i + step;
+                const IndexT end = min(i + step * 2, length);
+                parallelMerge(SA + i, mid - i, SA + mid, end - mid, SA + i - base, threads, compare);
+                parallelFor(i, end, threads, [SA, base](const unsigned long first, const unsigned long last)
+                {
+                    move(SA + first - base, SA + last - base, SA + first);
+                });
+            }
         }
-        step *= 2;
     }
 }
 
@@ -327,14 +694,15 @@ void mergeSort_Substrings(const unsigned long *const input, const unsigned long
 //  otherwise, the one on the right comes immediately after (rank_2 = rank_1 + 1).
 // maybe this could be done together with the merge sort?
 // note: could process the input from the end, starting with the highest representable character.
-void constructReducedProblem(const unsigned long *const input, const unsigned long length, unsigned long * const SA, const unsigned long nS, const bool usingLType)
+template<typename CharT, typename IndexT>
+void constructReducedProblem(const CharT *const input, const IndexT length, IndexT * const SA, const IndexT nS, const bool usingLType, const TypeBits *const types = nullptr)
 {
-    unsigned long currentChar = 0;
+    IndexT currentChar = 0;
     SA[0] = currentChar;
 
-    for (unsigned long i = length - nS + 1; i < length; ++i)
+    for (IndexT i = length - nS + 1; i < length; ++i)
     {
-        if (compare_substrings(input, SA[i - 1], SA[i], length, usingLType) != 0)
+        if (compare_substrings(input, SA[i - 1], SA[i], length, usingLType, types) != 0)
         {
             ++currentChar;
         }
@@ -346,28 +714,77 @@ void constructReducedProblem(const unsigned long *const input, const unsigned lo
 // sorts the reduced problem using heap sort
 // the reduced problem is stored in SA[length-nS, length-1]
 // when swapping elements, we also swap the corresponding indices in SA[0, nS-1]
-void heapSortReducedProblem(unsigned long *const SA, const unsigned long length, const unsigned long nS)
+template<typename IndexT>
+void heapSortReducedProblem(IndexT *const SA, const IndexT length, const IndexT nS)
 {
     BuildHeap(SA, length, nS);
-    unsigned long * const array = SA + length - nS;
-    for (unsigned long i = nS - 1; i > 0; --i)
+    IndexT * const array = SA + length - nS;
+    for (IndexT i = nS - 1; i > 0; --i)
     {
         std::swap(array[0], array[i]);
         std::swap(SA[0], SA[i]);
-        Heapify(SA, array, i, 0);
+        Heapify(SA, array, i, IndexT(0));
+    }
+}
+
+// section 5.3 - step 2, linear time alternative to the heap sort when scratch memory is available
+// the keys are the positions in SA[length-nS, length-1], which are distinct and smaller than length,
+// so an LSD radix sort (one pass per byte of length) moves the names in SA[0, nS-1] in text order.
+// scratch must have room for 2*nS elements
+template<typename IndexT>
+void radixSortReducedProblem(IndexT *const SA, const IndexT length, const IndexT nS, IndexT *const scratch)
+{
+    constexpr unsigned DIGIT_BITS = 8;
+    constexpr IndexT DIGITS = IndexT(1) << DIGIT_BITS;
+
+    IndexT *keys = SA + length - nS;
+    IndexT *names = SA;
+    IndexT *keys_out = scratch;
+    IndexT *names_out = scratch + nS;
+    IndexT count[DIGITS];
+
+    for (unsigned shift = 0; shift < numeric_limits<IndexT>::digits && ((length - 1) >> shift) != 0; shift += DIGIT_BITS)
+    {
+        fill(count, count + DIGITS, 0);
+        for (IndexT i = 0; i < nS; ++i)
+        {
+            ++count[(keys[i] >> shift) & (DIGITS - 1)];
+        }
+        IndexT sum = 0;
+        for (IndexT d = 0; d < DIGITS; ++d)
+        {
+            const IndexT c = count[d];
+            count[d] = sum;
+            sum += c;
+        }
+        for (IndexT i = 0; i < nS; ++i)
+        {
+            const IndexT destination = count[(keys[i] >> shift) & (DIGITS - 1)]++;
+            keys_out[destination] = keys[i];
+            names_out[destination] = names[i];
+        }
+        swap(keys, keys_out);
+        swap(names, names_out);
+    }
+
+    if (names != SA)
+    {
+        copy(keys, keys + nS, SA + length - nS);
+        copy(names, names + nS, SA);
     }
 }
 
 // section 5.4
-void RestoreFromRecursion(const unsigned long *const input, const unsigned long length, unsigned long *const SA, const unsigned long nS, const bool usingLType)
+template<typename CharT, typename IndexT>
+void RestoreFromRecursion(const CharT *const input, const IndexT length, IndexT *const SA, const IndexT nS, const bool usingLType, const TypeBits *const types = nullptr)
 {
     // restore
     bool nextIsL = false;
-    unsigned long sum = 0;
-    for (unsigned long i = 0; i < length; ++i)
+    IndexT sum = 0;
+    for (IndexT i = 0; i < length; ++i)
     {
-        const unsigned long index = length - i - 1;
-        const bool currentIsL = (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
+        const IndexT index = length - i - 1;
+        const bool currentIsL = types ? types->isL(index) : (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
         if ((!currentIsL && !usingLType) || (currentIsL && usingLType))
         {
             ++sum;
@@ -376,7 +793,7 @@ void RestoreFromRecursion(const unsigned long *const input, const unsigned long
         nextIsL = currentIsL;
     }
 
-    for (unsigned long i = length - nS; i < length; ++i)
+    for (IndexT i = length - nS; i < length; ++i)
     {
         SA[i] = SA[SA[i]];
     }
@@ -386,14 +803,15 @@ void RestoreFromRecursion(const unsigned long *const input, const unsigned long
 // at this point, the S-suffixes are already relatively sorted in SA[length-nS, length-1]
 // we are now putting the L-suffixes in SA[0, length-nS-1]
 // then we sort the whole SA using mergesort, sorting key for SA[i] is T[SA[i]]
-void preprocess(const unsigned long *const input, unsigned long * const SA, const unsigned long length, const unsigned long nS, const bool usingLType)
+template<typename CharT, typename IndexT>
+void preprocess(const CharT *const input, IndexT * const SA, const IndexT length, const IndexT nS, const bool usingLType, const TypeBits *const types = nullptr)
 {
     bool nextIsL = false;
-    unsigned long last_inserted_index = length - nS;
-    for (unsigned long i = 0; i < length; ++i)
+    IndexT last_inserted_index = length - nS;
+    for (IndexT i = 0; i < length; ++i)
     {
-        const unsigned long index = length - i - 1;
-        const bool currentIsL = (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
+        const IndexT index = length - i - 1;
+        const bool currentIsL = types ? types->isL(index) : (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
 
         if ((currentIsL && !usingLType) || (!currentIsL && usingLType))
         {
@@ -404,47 +822,106 @@ void preprocess(const unsigned long *const input, unsigned long * const SA, cons
 
     // Then, we sort SA[0 ... n − 1] (the sorting key of SA[i] is T [SA[i]] i.e., the ﬁrst character of suf(SA[i]))
     //  using the mergesort, with the merging step implemented by the stable, in-place, linear time merging algorithm
-    const auto compare = [input](const unsigned long a, const unsigned long b)
+    const auto compare = [input](const IndexT a, const IndexT b)
     {
         return input[a] < input[b];
     };
 
-    unsigned long step = 1;
+    IndexT step = 1;
     while (step < length)
     {
-        for (unsigned long i = 0; i < length - step; i += step * 2)
+        for (IndexT i = 0; i < length - step; i += step * 2)
         {
-            const unsigned long mid = i + step;
-            const unsigned long end = min(i + step * 2, length);
+            const IndexT mid = i + step;
+            const IndexT end = min(i + step * 2, length);
             inplace_merge(SA + i, SA + mid, SA + end, compare);
         }
         step *= 2;
     }
 }
 
+// section 5.5 - preprocessing, linear time alternative for small alphabets (needs the bucket index)
+// the S-suffixes in SA[length-nS, length-1] are sorted, hence already sorted by first character:
+// each of them moves left to the tail of its bucket (the destinations never pass an unread S-suffix),
+// then the L-suffixes are distributed in the free heads of the buckets, in text order like the mergesort would
+template<typename CharT, typename IndexT>
+void preprocess_buckets(const CharT *const input, IndexT * const SA, const IndexT length, const IndexT nS, const bool usingLType, SuffixArrayContext<IndexT> &context, const TypeBits *const types = nullptr)
+{
+    const vector<IndexT> &heads = context.bucket_heads;
+    const unsigned long offset = context.bucket_offset;
+
+    // fill_L[c] = number of L-suffixes in bucket c
+    vector<IndexT> &fill_L = context.bucket_fill;
+    fill_L.assign(heads.size(), 0);
+    bool nextIsL = false;
+    for (IndexT i = 0; i < length; ++i)
+    {
+        const IndexT index = length - i - 1;
+        const bool currentIsL = types ? types->isL(index) : (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
+        if ((currentIsL && !usingLType) || (!currentIsL && usingLType))
+        {
+            ++fill_L[input[index] - offset];
+        }
+        nextIsL = currentIsL;
+    }
+
+    // the S-suffixes of bucket c go after its L-suffixes
+    IndexT destination = 0;
+    unsigned long currentBucket = heads.size();
+    for (IndexT i = length - nS; i < length; ++i)
+    {
+        const unsigned long c = input[SA[i]] - offset;
+        if (c != currentBucket)
+        {
+            currentBucket = c;
+            destination = heads[c] + fill_L[c];
+        }
+        SA[destination++] = SA[i];
+    }
+
+    // L-suffixes from right to left, each bucket filled from the end of its L part
+    for (unsigned long c = 0; c + 1 < heads.size(); ++c)
+    {
+        fill_L[c] += heads[c];
+    }
+    nextIsL = false;
+    for (IndexT i = 0; i < length; ++i)
+    {
+        const IndexT index = length - i - 1;
+        const bool currentIsL = types ? types->isL(index) : (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
+        if ((currentIsL && !usingLType) || (!currentIsL && usingLType))
+        {
+            SA[--fill_L[input[index] - offset]] = index;
+        }
+        nextIsL = currentIsL;
+    }
+}
+
 // section 5.5 - step 1
 // this initializes the suffix array with special symbols that inform us on the number
 // of L-type suffixes in each bucket.
-void initializeSA(const unsigned long *const input, unsigned long * const SA, const unsigned long length, const bool usingLType)
+template<typename CharT, typename IndexT>
+void initializeSA(const CharT *const input, IndexT * const SA, const IndexT length, const bool usingLType, const SuffixArrayContext<IndexT> &context, const TypeBits *const types = nullptr)
 {
     // we scan T from right to left
     bool nextIsL = false;
-    for (unsigned long i = 0; i < length; ++i)
+    for (IndexT i = 0; i < length; ++i)
     {
-        unsigned long index = length - i - 1;
-        const bool currentIsL = (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
+        IndexT index = length - i - 1;
+        const bool currentIsL = types ? types->isL(index) : (index == length - 1) || (input[index] > input[index + 1] || (nextIsL && input[index] == input[index + 1]));
         // for each scanning character T[i] which is L_TYPE, if bucket T[i] has not been initialized yet, we initialize it
 
         if ((currentIsL && !usingLType) || (!currentIsL && usingLType))
         {
             // Let l denote the head of bucket T [i ] in SA (i.e. l is the smallest index in SA such that T [SA[l]] = T [i])
-            //  We can find l by searching T [i ] in SA (the search key for SA[i ] is T [SA[i ]]) using binary search.
-            unsigned long l;
-            const unsigned long first = custom_binary_search(input, SA, length, input[index], usingLType);
+            //  We can find l by searching T [i ] in SA (the search key for SA[i ] is T [SA[i ]]) using binary search,
+            //  or in O(1) with the bucket index when the alphabet is small.
+            IndexT l;
+            const IndexT first = bucketHead(input, SA, length, input[index], usingLType, context);
 
             if (usingLType)
             {
-                l = custom_binary_search_last(input, SA, length, input[index]);
+                l = bucketTail(input, SA, length, input[index], context);
             }
             else
             {
@@ -455,8 +932,8 @@ void initializeSA(const unsigned long *const input, unsigned long * const SA, co
                 // obviously this is the only suffix in this bucket
                 continue;
             }
-            const unsigned long position = usingLType ? l - 1 : l + 1;
-            const unsigned long further_position = usingLType ? l - 2 : l + 2;
+            const IndexT position = usingLType ? l - 1 : l + 1;
+            const IndexT further_position = usingLType ? l - 2 : l + 2;
 
             if (SA[position] >= length)
             {
@@ -466,7 +943,7 @@ void initializeSA(const unsigned long *const input, unsigned long * const SA, co
 
             // we let rL denote the tail of L-suffixes in this bucket (i.e., rL is the largest index in SA such
             // that T[SA[rL]] = T[i] and T[SA[rL]] is L-type).
-            unsigned long rL = l;
+            IndexT rL = l;
 
             while (rL < length && SA[rL] != index)
             {
@@ -477,7 +954,7 @@ void initializeSA(const unsigned long *const input, unsigned long * const SA, co
             }
 
             // Note that nL = rL - l + 1. Hence, it suffices to compute l and rL.
-            const unsigned long nL = ((usingLType) ? rL - first + 1 : rL - l + 1);
+            const IndexT nL = ((usingLType) ? rL - first + 1 : rL - l + 1);
             if (usingLType)
             {
                 // s-types (left) and l-types (right) must be swapped
@@ -486,24 +963,24 @@ void initializeSA(const unsigned long *const input, unsigned long * const SA, co
 
             if (nL == 2)
             {
-                SA[position] = BT;
+                SA[position] = BT<IndexT>;
             }
             else if (nL == 3)
             {
-                SA[position] = BH;
-                SA[further_position] = BT;
+                SA[position] = BH<IndexT>;
+                SA[further_position] = BT<IndexT>;
             }
             else if (nL > 3)
             {
-                SA[position] = BH;
-                SA[further_position] = E;
+                SA[position] = BH<IndexT>;
+                SA[further_position] = E<IndexT>;
                 if (usingLType)
                 {
-                    SA[l - nL + 1] = BT;
+                    SA[l - nL + 1] = BT<IndexT>;
                 }
                 else
                 {
-                    SA[l + nL - 1] = BT;
+                    SA[l + nL - 1] = BT<IndexT>;
                 }
             }
         }
@@ -511,58 +988,58 @@ void initializeSA(const unsigned long *const input, unsigned long * const SA, co
     }
 }
 
-unsigned long case4_L_cached_l = ULONG_MAX;
-void case4(const unsigned long *const input, unsigned long *const SA, const unsigned long l, const unsigned long j, const unsigned long length)
+template<typename CharT, typename IndexT>
+void case4(const CharT *const input, IndexT *const SA, const IndexT l, const IndexT j, const IndexT length, SuffixArrayContext<IndexT> &context)
 {
     // case 4 cannot be applied multiple times for the same l in one induced sorting step, this caching mechanism avoids redundant work (with great performance improvements)
-    if (case4_L_cached_l != ULONG_MAX && l == case4_L_cached_l) {
+    ++context.case4_calls;
+    if (context.case4_L_cached_l != numeric_limits<IndexT>::max() && l == context.case4_L_cached_l) {
+        ++context.case4_cache_hits;
         return;
     }
     else {
-        case4_L_cached_l = l;
+        context.case4_L_cached_l = l;
     }
 
-    unsigned long rL = l + 1;
-    while (rL < length && SA[rL] != R1 && (SA[rL] < length && input[SA[rL]] == input[j]))
+    IndexT rL = l + 1;
+    while (rL < length && SA[rL] != R1<IndexT> && (SA[rL] < length && input[SA[rL]] == input[j]))
     {
         ++rL;
     }
-    // if R1 is found (if not, it's either case nL=1 or current was not L-type)
-    if (rL != length && (SA[rL] == R1 || (SA[rL] < length && input[SA[rL]] == input[j])))
+    // if R1<IndexT> is found (if not, it's either case nL=1 or current was not L-type)
+    if (rL != length && (SA[rL] == R1<IndexT> || (SA[rL] < length && input[SA[rL]] == input[j])))
     {
         SA[rL] = j;
     }
 }
 
-unsigned long case4_S_cached_l = ULONG_MAX;
-void case4_S(const unsigned long *const input, unsigned long *const SA, const unsigned long l, const unsigned long j, const unsigned long length)
+template<typename CharT, typename IndexT>
+void case4_S(const CharT *const input, IndexT *const SA, const IndexT l, const IndexT j, const IndexT length, SuffixArrayContext<IndexT> &context)
 {
     // case 4 cannot be applied multiple times for the same l in one induced sorting step, this caching mechanism avoids redundant work (with great performance improvements)
-    if (case4_S_cached_l != ULONG_MAX && l == case4_S_cached_l) {
+    ++context.case4_calls;
+    if (context.case4_S_cached_l != numeric_limits<IndexT>::max() && l == context.case4_S_cached_l) {
+        ++context.case4_cache_hits;
         return;
     }
     else {
-        case4_S_cached_l = l;
+        context.case4_S_cached_l = l;
     }
 
-    unsigned long rL = l;
-    while (rL > 0 && SA[rL - 1] != R1 && input[SA[rL - 1]] == input[j])
+    IndexT rL = l;
+    while (rL > 0 && SA[rL - 1] != R1<IndexT> && input[SA[rL - 1]] == input[j])
     {
         --rL;
     }
-    // if R1 is found (if not, it's either case nS=1 or current was not S-type)
-    if (rL != 0 && SA[rL - 1] == R1)
+    // if R1<IndexT> is found (if not, it's either case nS=1 or current was not S-type)
+    if (rL != 0 && SA[rL - 1] == R1<IndexT>)
     {
         SA[rL - 1] = j;
     }
 }
 
-void reset_case4_caches() {
-    case4_L_cached_l = ULONG_MAX;
-    case4_S_cached_l = ULONG_MAX;
-}
-
-inline void sortS_body(const unsigned long *const input, unsigned long *const SA, const unsigned long length, const unsigned long j)
+template<typename CharT, typename IndexT>
+inline void sortS_body(const CharT *const input, IndexT *const SA, const IndexT length, const IndexT j, SuffixArrayContext<IndexT> &context)
 {
 
     // skip L type suffixes, this does not cover case 4 (but is always true for case 4)
@@ -571,7 +1048,7 @@ inline void sortS_body(const unsigned long *const input, unsigned long *const SA
         return;
     }
 
-    const unsigned long l = custom_binary_search_last(input, SA, length, input[j]); // modified to look for the last occurrence
+    const IndexT l = bucketTail(input, SA, length, input[j], context); // modified to look for the last occurrence
     if (l == 0)
     {
         // skipping as edge case, clearly the only suffix in the bucket
@@ -579,54 +1056,54 @@ inline void sortS_body(const unsigned long *const input, unsigned long *const SA
     }
     else if (input[j] == input[j + 1])
     {
-        if (!(SA[l - 1] == BH || SA[l - 1] == R2 || SA[l - 1] == R1 || SA[l - 1] == BT))
+        if (!(SA[l - 1] == BH<IndexT> || SA[l - 1] == R2<IndexT> || SA[l - 1] == R1<IndexT> || SA[l - 1] == BT<IndexT>))
         {
             // skip if bucket is filled (j is not L-type)
-            case4_S(input, SA, l, j, length);
+            case4_S(input, SA, l, j, length, context);
             return;
         }
     }
-    const unsigned long prev = SA[l - 1];
+    const IndexT prev = SA[l - 1];
 
     // nL = 2?
-    if (prev == BT)
+    if (prev == BT<IndexT>)
     {
         // nL = 2, first to put in
         SA[l] = j;
-        SA[l - 1] = R1; // not in the paper, but how I implemented it
+        SA[l - 1] = R1<IndexT>; // not in the paper, but how I implemented it
     }
-    else if (prev == R1)
+    else if (prev == R1<IndexT>)
     {
         // nL = 2, second to put in
         SA[l - 1] = j;
     }
-    else if (prev == BH)
+    else if (prev == BH<IndexT>)
     {
-        if (SA[l - 2] == E)
+        if (SA[l - 2] == E<IndexT>)
         {
             // case 1
             SA[l] = j;
             SA[l - 2] = 1; // counter for the number of L-type suffixes put so far
         }
-        else if (SA[l - 2] == BT)
+        else if (SA[l - 2] == BT<IndexT>)
         { // not in the paper, nL=3, first to put in
             SA[l] = j;
-            SA[l - 2] = R2; // not in the paper, but how I implemented it
+            SA[l - 2] = R2<IndexT>; // not in the paper, but how I implemented it
         }
-        else if (SA[l - 2] == R2)
+        else if (SA[l - 2] == R2<IndexT>)
         { // not in the paper, nL=3, second to put in
             SA[l - 1] = j;
-            SA[l - 2] = R1; // not in the paper, but how I implemented it
+            SA[l - 2] = R1<IndexT>; // not in the paper, but how I implemented it
         }
-        else if (SA[l - 2] == R1)
+        else if (SA[l - 2] == R1<IndexT>)
         {
             // nL = 3, third to put in
             SA[l - 2] = j;
         }
         else
         {
-            const unsigned long c = SA[l - 2];
-            if (SA[l - c - 2] != BT)
+            const IndexT c = SA[l - 2];
+            if (SA[l - c - 2] != BT<IndexT>)
             {
                 // case 2 (1)
                 SA[l - c - 2] = j;
@@ -635,32 +1112,33 @@ inline void sortS_body(const unsigned long *const input, unsigned long *const SA
             else
             {
                 // case 2 (2)
-                const unsigned long rL = l - 2 - c;
+                const IndexT rL = l - 2 - c;
                 std::move(SA + rL + 1, SA + l - 2, SA + rL + 2);
                 SA[rL + 1] = j;
-                SA[l - 1] = R2;
+                SA[l - 1] = R2<IndexT>;
             }
         }
     }
-    else if (prev == R2)
+    else if (prev == R2<IndexT>)
     {
         // case 3
-        unsigned long rL = l - 2;
-        while (SA[rL] != BT)
+        IndexT rL = l - 2;
+        while (SA[rL] != BT<IndexT>)
         {
             --rL;
         }
         move(SA + rL + 1, SA + l - 1, SA + rL + 2);
         SA[rL + 1] = j;
-        SA[rL] = R1;
+        SA[rL] = R1<IndexT>;
     }
     else
     {
-        case4_S(input, SA, l, j, length);
+        case4_S(input, SA, l, j, length, context);
     }
 }
 
-inline void sortL_body(const unsigned long *const input, unsigned long *const SA, const unsigned long length, const unsigned long j)
+template<typename CharT, typename IndexT>
+inline void sortL_body(const CharT *const input, IndexT *const SA, const IndexT length, const IndexT j, SuffixArrayContext<IndexT> &context)
 {
     // skip S type suffixes, this does not cover case 4 (but is always true for case 4)
     if (j != length - 1 && input[j] < input[j + 1])
@@ -668,7 +1146,7 @@ inline void sortL_body(const unsigned long *const input, unsigned long *const SA
         return;
     }
 
-    const unsigned long l = custom_binary_search(input, SA, length, input[j], false);
+    const IndexT l = bucketHead(input, SA, length, input[j], false, context);
     if (l == length - 1)
     {
         // skipping as edge case, clearly the only suffix in the bucket
@@ -676,54 +1154,54 @@ inline void sortL_body(const unsigned long *const input, unsigned long *const SA
     }
     else if (j != length - 1 && input[j] == input[j + 1])
     {
-        if (!(SA[l + 1] == BH || SA[l + 1] == R2 || SA[l + 1] == R1 || SA[l + 1] == BT))
+        if (!(SA[l + 1] == BH<IndexT> || SA[l + 1] == R2<IndexT> || SA[l + 1] == R1<IndexT> || SA[l + 1] == BT<IndexT>))
         {
             // skip if bucket is filled (j is not L-type)
-            case4(input, SA, l, j, length);
+            case4(input, SA, l, j, length, context);
             return;
         }
     }
 
-    if (SA[l + 1] == BT)
+    if (SA[l + 1] == BT<IndexT>)
     {
         // nL = 2, first to put in
         SA[l] = j;
-        SA[l + 1] = R1; // not in the paper, but how I implemented it
+        SA[l + 1] = R1<IndexT>; // not in the paper, but how I implemented it
     }
-    else if (SA[l + 1] == R1)
+    else if (SA[l + 1] == R1<IndexT>)
     {
         // nL = 2, second to put in
         SA[l + 1] = j;
     }
-    else if (SA[l + 1] == BH)
+    else if (SA[l + 1] == BH<IndexT>)
     {
-        if (SA[l + 2] == E)
+        if (SA[l + 2] == E<IndexT>)
         {
             // case 1
             SA[l] = j;
             SA[l + 2] = 1; // counter for the number of L-type suffixes put so far
         }
-        else if (SA[l + 2] == BT)
+        else if (SA[l + 2] == BT<IndexT>)
         { // not in the paper, nL=3, first to put in
             // nL = 3, first to put in
             SA[l] = j;
-            SA[l + 2] = R2; // not in the paper, but how I implemented it
+            SA[l + 2] = R2<IndexT>; // not in the paper, but how I implemented it
         }
-        else if (SA[l + 2] == R2)
+        else if (SA[l + 2] == R2<IndexT>)
         { // not in the paper, nL=3, second to put in
             // nL = 3, second to put in
             SA[l + 1] = j;
-            SA[l + 2] = R1; // not in the paper, but how I implemented it
+            SA[l + 2] = R1<IndexT>; // not in the paper, but how I implemented it
         }
-        else if (SA[l + 2] == R1)
+        else if (SA[l + 2] == R1<IndexT>)
         {
             // nL = 3, third to put in
             SA[l + 2] = j;
         }
         else
         {
-            const unsigned long c = SA[l + 2];
-            if (SA[l + c + 2] != BT)
+            const IndexT c = SA[l + 2];
+            if (SA[l + c + 2] != BT<IndexT>)
             {
                 // case 2 (1)
                 SA[l + c + 2] = j;
@@ -732,65 +1210,67 @@ inline void sortL_body(const unsigned long *const input, unsigned long *const SA
             else
             {
                 // case 2 (2)
-                const unsigned long rL = l + 2 + c;
+                const IndexT rL = l + 2 + c;
                 move(SA + l + 3, SA + rL, SA + l + 2);
                 SA[rL - 1] = j;
-                SA[l + 1] = R2;
+                SA[l + 1] = R2<IndexT>;
             }
         }
     }
-    else if (SA[l + 1] == R2)
+    else if (SA[l + 1] == R2<IndexT>)
     {
         // case 3
-        unsigned long rL = l + 2;
-        while (rL != length - 1 && SA[rL] != BT)
+        IndexT rL = l + 2;
+        while (rL != length - 1 && SA[rL] != BT<IndexT>)
         {
             ++rL;
         }
         move(SA + l + 2, SA + rL, SA + l + 1);
         SA[rL - 1] = j;
-        SA[rL] = R1;
+        SA[rL] = R1<IndexT>;
     }
     else
     {
-        case4(input, SA, l, j, length);
+        case4(input, SA, l, j, length, context);
     }
 }
 
-void sortS(const unsigned long *const input, unsigned long * const SA, const unsigned long length)
+template<typename CharT, typename IndexT>
+void sortS(const CharT *const input, IndexT * const SA, const IndexT length, SuffixArrayContext<IndexT> &context)
 {
-    for (unsigned long iter = 1; iter <= length; ++iter)
+    for (IndexT iter = 1; iter <= length; ++iter)
     {
-        const unsigned long i = length - iter;
+        const IndexT i = length - iter;
         if (SA[i] == 0)
             continue;
 
         // does this ever happen? Should this happen?
         if (SA[i] >= length)
         {
-            if (SA[i] == BH)
+            if (SA[i] == BH<IndexT>)
                 ++iter; // skips counter
                 
             continue;
         }
 
-        unsigned long j = SA[i] - 1;
-        sortS_body(input, SA, length, j);
+        IndexT j = SA[i] - 1;
+        sortS_body(input, SA, length, j, context);
 
         // does this ever happen? Should this happen?
         while (SA[i] - 1 != j && SA[i] < length && SA[i] != 0) // changed current, repeat.
         {
             j = SA[i] - 1;
-            sortS_body(input, SA, length, j);
+            sortS_body(input, SA, length, j, context);
         }
     }
 }
 
-void sortL(const unsigned long *const input, unsigned long * const SA, const unsigned long length)
+template<typename CharT, typename IndexT>
+void sortL(const CharT *const input, IndexT * const SA, const IndexT length, SuffixArrayContext<IndexT> &context)
 {
-    sortL_body(input, SA, length, length - 1);
+    sortL_body(input, SA, length, length - 1, context);
 
-    for (unsigned long i = 0; i < length; ++i)
+    for (IndexT i = 0; i < length; ++i)
     {
         if (SA[i] == 0)
             continue;
@@ -798,37 +1278,40 @@ void sortL(const unsigned long *const input, unsigned long * const SA, const uns
         // does this ever happen? Should this happen?
         if (SA[i] >= length)
         {
-            if (SA[i] == BH)
+            if (SA[i] == BH<IndexT>)
                 ++i; // skips counter
                 
             continue;
         }
 
-        unsigned long j = SA[i] - 1;
-        sortL_body(input, SA, length, j);
+        IndexT j = SA[i] - 1;
+        sortL_body(input, SA, length, j, context);
 
         // does this ever happen? Should this happen?
         while (SA[i] - 1 != j && SA[i] < length && SA[i] != 0) // changed current, repeat.
         {
             j = SA[i] - 1;
-            sortL_body(input, SA, length, j);
+            sortL_body(input, SA, length, j, context);
         }
     }
 }
 
 // section 5.5 - step 2
 // for usingLType=true, go from right to left and keep the "rightmost free" instead of leftmost free
-void inducedSorting(const unsigned long *const input, unsigned long * const SA, const unsigned long length, const bool usingLType)
+template<typename CharT, typename IndexT>
+void inducedSorting(const CharT *const input, IndexT * const SA, const IndexT length, const bool usingLType, SuffixArrayContext<IndexT> &context)
 {
-    reset_case4_caches();
+    context.reset_case4_caches();
     if (usingLType)
-        sortS(input, SA, length);
+        sortS(input, SA, length, context);
     else
-        sortL(input, SA, length);
+        sortL(input, SA, length, context);
 }
 
-bool optimalSuffixArray_first(const unsigned long *const input, unsigned long *const SA, const unsigned long length, unsigned long &nS)
+template<typename CharT, typename IndexT>
+bool optimalSuffixArray_first(const CharT *const input, IndexT *const SA, const IndexT length, IndexT &nS, SuffixArrayContext<IndexT> &context)
 {
+    ++context.levels;
     if (length < 2)
     {
         if (length == 1)
@@ -839,10 +1322,12 @@ bool optimalSuffixArray_first(const unsigned long *const input, unsigned long *c
     }
 
     // check if nS <= nL
-    nS = countS_Type(input, length);
+    const TypeBits * const types = buildTypes(input, length, context);
+    nS = types ? types->nS : countS_Type(input, length);
     if (nS == 0)
     {
-        for (unsigned long i = 0; i < length; ++i)
+        releaseTypes(length, context);
+        for (IndexT i = 0; i < length; ++i)
         {
             SA[i] = length - i - 1;
         }
@@ -856,22 +1341,32 @@ bool optimalSuffixArray_first(const unsigned long *const input, unsigned long *c
     }
 
     // step 1
-    placeIndicesOf_Type(input, length, SA, usingLType);
+    placeIndicesOf_Type(input, length, SA, usingLType, types);
 
     // step 2
-    mergeSort_Substrings(input, length, SA, nS, usingLType);
+    mergeSort_Substrings(input, length, SA, nS, usingLType, context.threads, types, context.performance_mode);
 
     // step 3
-    constructReducedProblem(input, length, SA, nS, usingLType);
+    constructReducedProblem(input, length, SA, nS, usingLType, types);
 
     // step 4 (no need to adapt the heap sort for L-type suffixes, it works as is)
-    heapSortReducedProblem(SA, length, nS);
+    IndexT * const scratch = context.getScratch(2 * static_cast<unsigned long>(nS));
+    if (scratch)
+    {
+        radixSortReducedProblem(SA, length, nS, scratch);
+    }
+    else
+    {
+        heapSortReducedProblem(SA, length, nS);
+    }
 
     return true;
 }
 
-void optimalSuffixArray_second(const unsigned long *const input, unsigned long *const SA, const unsigned long length) {
-    unsigned long nS = countS_Type(input, length);
+template<typename CharT, typename IndexT>
+void optimalSuffixArray_second(const CharT *const input, IndexT *const SA, const IndexT length, SuffixArrayContext<IndexT> &context) {
+    const TypeBits * const types = currentTypes(length, context);
+    IndexT nS = types ? types->nS : countS_Type(input, length);
 
     const bool usingLType = (length - nS) < nS; // if there are more L-type suffixes, we swap the roles of S and L
     if (usingLType)
@@ -880,50 +1375,63 @@ void optimalSuffixArray_second(const unsigned long *const input, unsigned long *
     }
     
     // step 5
-    RestoreFromRecursion(input, length, SA, nS, usingLType);
+    RestoreFromRecursion(input, length, SA, nS, usingLType, types);
 
-    // step 6
-    preprocess(input, SA, length, nS, usingLType);
+    // step 6 (linear time when the bucket index of the level fits the scratch budget, opt-in)
+    buildBucketIndex(input, length, context);
+    if (context.has_bucket_index)
+    {
+        preprocess_buckets(input, SA, length, nS, usingLType, context, types);
+    }
+    else
+    {
+        preprocess(input, SA, length, nS, usingLType, types);
+    }
 
     // step 7
-    initializeSA(input, SA, length, usingLType);
+    initializeSA(input, SA, length, usingLType, context, types);
+    releaseTypes(length, context);
 
     // step 8
-    inducedSorting(input, SA, length, usingLType);
+    inducedSorting(input, SA, length, usingLType, context);
 }
 
-void optimalSuffixArray(unsigned long *const input, unsigned long *const SA, const unsigned long length)
+// CharT is the alphabet of the input, only read at the top level of the recursion.
+// IndexT is the type of the suffix array and of the reduced problems stored in it,
+// length must not exceed maxLengthFor<IndexT>() (e.g. uint32_t halves the memory for inputs below 2^31)
+template<typename CharT, typename IndexT>
+void optimalSuffixArray(const CharT *const input, IndexT *const SA, const IndexT length, SuffixArrayContext<IndexT> &context)
 {
-    unsigned long prev_nS;
-    bool needsRecursion = optimalSuffixArray_first(input, SA, length, prev_nS);
+    IndexT prev_nS;
+    bool needsRecursion = optimalSuffixArray_first(input, SA, length, prev_nS, context);
     if (!needsRecursion)
     {
         return;
     }
 
-    unsigned long *old_output = SA;
-    unsigned long old_length = length;
-    unsigned long new_output_index = 0;
-    unsigned long old_old_length = old_length;
-    unsigned long recursionDepth = 0;
-    unsigned long *new_input;
+    IndexT *old_output = SA;
+    IndexT old_length = length;
+    IndexT new_output_index = 0;
+    IndexT old_old_length = old_length;
+    IndexT recursionDepth = 0;
+    IndexT *new_input;
     while (needsRecursion) {
         new_input = old_output;
-        unsigned long new_length = prev_nS;
-        unsigned long *new_output = old_output + old_length - new_length;
+        IndexT new_length = prev_nS;
+        IndexT *new_output = old_output + old_length - new_length;
         
         // cleaning up before recursion
-        bool prev_had_space = new_input[0] & MSB;
+        bool prev_had_space = new_input[0] & MSB<IndexT>;
         if (prev_had_space) {
-            new_input[0] &= ~MSB;
+            new_input[0] &= ~MSB<IndexT>;
         }
 
         // recursion
-        needsRecursion = optimalSuffixArray_first(new_input, new_output, new_length, prev_nS);
+        needsRecursion = optimalSuffixArray_first(new_input, new_output, new_length, prev_nS, context);
         
         // restoring after recursion
         if (prev_had_space) {
-            new_input[0] |= MSB;
+            new_input[0] |= MSB<IndexT>;
         }
 
         // get ready for next recursive call
@@ -933,7 +1441,7 @@ void optimalSuffixArray(unsigned long *const input, unsigned long *const SA, con
 
             // make sure I store information to go back later
             if (new_length*2 != old_length) {
-                new_output[0] |= MSB;
+                new_output[0] |= MSB<IndexT>;
                 new_output[-1] = old_length;
             }
 
@@ -944,14 +1452,14 @@ void optimalSuffixArray(unsigned long *const input, unsigned long *const SA, con
         old_length = new_length;
     }
     
-    unsigned long *old_input = new_input;
+    IndexT *old_input = new_input;
 
     while (recursionDepth-- > 0) {
 
         old_length = old_old_length;
-        const bool had_space = old_input[0] & MSB;
+        const bool had_space = old_input[0] & MSB<IndexT>;
         if (had_space) {
-            old_input[0] &= ~MSB;
+            old_input[0] &= ~MSB<IndexT>;
             old_old_length = old_input[-1];
         }
         else {
@@ -962,35 +1470,49 @@ void optimalSuffixArray(unsigned long *const input, unsigned long *const SA, con
         new_output_index += old_length - old_old_length;
         old_input = &SA[new_output_index];
 
-        const bool current_have_space = old_input[0] & MSB;
+        const bool current_have_space = old_input[0] & MSB<IndexT>;
         if (current_have_space) {
-            old_input[0] &= ~MSB;
+            old_input[0] &= ~MSB<IndexT>;
         }
 
-        optimalSuffixArray_second(old_input, old_output, old_length);
+        optimalSuffixArray_second(old_input, old_output, old_length, context);
 
         if (current_have_space) {
-            old_input[0] |= MSB;
+            old_input[0] |= MSB<IndexT>;
         }
     }
-    optimalSuffixArray_second(input, SA, length);
+    optimalSuffixArray_second(input, SA, length, context);
 }
 
-
-// wrapper for char input
-void optimalSuffixArray(const char * const input_chars, unsigned long *const SA, const unsigned long length)
+template<typename CharT, typename IndexT>
+void optimalSuffixArray(const CharT *const input, IndexT *const SA, const IndexT length)
 {
-    unsigned long * const input = new unsigned long[length];
-    char_to_ulong_array(input_chars, input, length);
+    SuffixArrayContext<IndexT> context;
+    optimalSuffixArray(input, SA, length, context);
+}
 
-    optimalSuffixArray(input, SA, length);
 
-    delete[] input;
+// wrapper for char input, the top level works directly on the bytes of the input,
+// only the reduced problems use IndexT as their alphabet
+template<typename IndexT>
+void optimalSuffixArray(const char * const input_chars, IndexT *const SA, const IndexT length, SuffixArrayContext<IndexT> &context)
+{
+    // bytes are compared as unsigned, consistently with strcmp
+    optimalSuffixArray(reinterpret_cast<const uint8_t*>(input_chars), SA, length, context);
+}
+
+template<typename IndexT>
+void optimalSuffixArray(const char * const input_chars, IndexT *const SA, const IndexT length)
+{
+    SuffixArrayContext<IndexT> context;
+    optimalSuffixArray(input_chars, SA, length, context);
 }
 
 // Recursive and simpler version of optimalSuffixArray, needs log(N) memory workload
-void optimalSuffixArray_recursive(const unsigned long *const input, unsigned long *const SA, const unsigned long length)
-{    
+template<typename CharT, typename IndexT>
+void optimalSuffixArray_recursive(const CharT *const input, IndexT *const SA, const IndexT length, SuffixArrayContext<IndexT> &context)
+{
+    ++context.levels;
     if (length < 2)
     {
         if (length == 1)
@@ -1001,10 +1523,12 @@ void optimalSuffixArray_recursive(const unsigned long *const input, unsigned lon
     }
 
     // check if nS <= nL
-    unsigned long nS = countS_Type(input, length);
+    const TypeBits *types = buildTypes(input, length, context);
+    IndexT nS = types ? types->nS : countS_Type(input, length);
     if (nS == 0)
     {
-        for (unsigned long i = 0; i < length; ++i)
+        releaseTypes(length, context);
+        for (IndexT i = 0; i < length; ++i)
         {
             SA[i] = length - i - 1;
         }
@@ -1018,29 +1542,56 @@ void optimalSuffixArray_recursive(const unsigned long *const input, unsigned lon
     }
 
     // step 1
-    placeIndicesOf_Type(input, length, SA, usingLType);
+    placeIndicesOf_Type(input, length, SA, usingLType, types);
 
     // step 2
-    mergeSort_Substrings(input, length, SA, nS, usingLType);
+    mergeSort_Substrings(input, length, SA, nS, usingLType, context.threads, types, context.performance_mode);
 
     // step 3
-    constructReducedProblem(input, length, SA, nS, usingLType);
+    constructReducedProblem(input, length, SA, nS, usingLType, types);
 
     // step 4 (no need to adapt the heap sort for L-type suffixes, it works as is)
-    heapSortReducedProblem(SA, length, nS);
+    IndexT * const scratch = context.getScratch(2 * static_cast<unsigned long>(nS));
+    if (scratch)
+    {
+        radixSortReducedProblem(SA, length, nS, scratch);
+    }
+    else
+    {
+        heapSortReducedProblem(SA, length, nS);
+    }
 
     // recursion
-    optimalSuffixArray_recursive(SA, SA + length - nS, nS);
+    optimalSuffixArray_recursive(SA, SA + length - nS, nS, context);
+    types = currentTypes(length, context); // the recursion may have moved the stack of types
 
     // step 5
-    RestoreFromRecursion(input, length, SA, nS, usingLType);
+    RestoreFromRecursion(input, length, SA, nS, usingLType, types);
 
-    // step 6
-    preprocess(input, SA, length, nS, usingLType);
+    // step 6 (linear time when the bucket index of the level fits the scratch budget, opt-in)
+    buildBucketIndex(input, length, context);
+    if (context.has_bucket_index)
+    {
+        preprocess_buckets(input, SA, length, nS, usingLType, context, types);
+    }
+    else
+    {
+        preprocess(input, SA, length, nS, usingLType, types);
+    }
 
     // step 7
-    initializeSA(input, SA, length, usingLType);
+    initializeSA(input, SA, length, usingLType, context, types);
+    releaseTypes(length, context);
 
     // step 8
-    inducedSorting(input, SA, length, usingLType);
-}
\ No newline at end of file
+    inducedSorting(input, SA, length, usingLType, context);
+}
+
+template<typename CharT, typename IndexT>
+void optimalSuffixArray_recursive(const CharT *const input, IndexT *const SA, const IndexT length)
+{
+    SuffixArrayContext<IndexT> context;
+    optimalSuffixArray_recursive(input, SA, length, context);
+}
+
+#endif
\ No newline at end of file
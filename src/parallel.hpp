@@ -0,0 +1,88 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+// minimal helpers to split work among threads, used by the multithreaded variants of the algorithms
+#include <algorithm>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// number of threads to use when 0 (= all cores) is requested
+unsigned resolveThreads(const unsigned threads)
+{
+    if (threads != 0)
+    {
+        return threads;
+    }
+    const unsigned cores = thread::hardware_concurrency();
+    return cores == 0 ? 1 : cores;
+}
+
+// calls body(chunk_begin, chunk_end) on at most `threads` contiguous chunks of [begin, end), each on its own thread
+template<typename Body>
+void parallelFor(const unsigned long begin, const unsigned long end, const unsigned threads, const Body &body)
+{
+    const unsigned long n = end - begin;
+    const unsigned long chunks = min<unsigned long>(threads, n);
+    if (chunks <= 1)
+    {
+        if (n > 0)
+        {
+            body(begin, end);
+        }
+        return;
+    }
+
+    vector<thread> workers;
+    for (unsigned long c = 1; c < chunks; ++c)
+    {
+        workers.emplace_back(body, begin + n * c / chunks, begin + n * (c + 1) / chunks);
+    }
+    body(begin, begin + n / chunks);
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// merge path: number of elements of A among the first `diagonal` elements of merge(A, B),
+// with the same tie breaking as std::merge (elements of A come first)
+template<typename T, typename Compare>
+unsigned long mergePathSplit(const T *const A, const unsigned long a, const T *const B, const unsigned long b, const unsigned long diagonal, const Compare &comp)
+{
+    unsigned long low = diagonal > b ? diagonal - b : 0;
+    unsigned long high = min(diagonal, a);
+    while (low < high)
+    {
+        const unsigned long mid = low + (high - low) / 2;
+        if (comp(B[diagonal - mid - 1], A[mid]))
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+// stable merge of A and B into output, split into independent pieces along the merge path
+template<typename T, typename Compare>
+void parallelMerge(const T *const A, const unsigned long a, const T *const B, const unsigned long b, T *const output, const unsigned threads, const Compare &comp)
+{
+    const unsigned long total = a + b;
+    parallelFor(0, threads, threads, [&](const unsigned long first, const unsigned long last)
+    {
+        for (unsigned long piece = first; piece < last; ++piece)
+        {
+            const unsigned long begin = total * piece / threads;
+            const unsigned long end = total * (piece + 1) / threads;
+            const unsigned long beginA = mergePathSplit(A, a, B, b, begin, comp);
+            const unsigned long endA = mergePathSplit(A, a, B, b, end, comp);
+            merge(A + beginA, A + endA, B + begin - beginA, B + end - endA, output + begin, comp);
+        }
+    });
+}
+
+#endif
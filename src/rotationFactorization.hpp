@@ -0,0 +1,270 @@
+#ifndef ROTATION_FACTORIZATION_HPP
+#define ROTATION_FACTORIZATION_HPP
+
+// Lyndon factorization of any rotation of a word, in O(number of factors) after O(n) preprocessing.
+// The least rotation of the word is r^k, with r a Lyndon word of length p. The rotation starting q symbols into
+// a copy of r, with r = uv and |u| = q, is v r^(k-1) u: its factors are the ones of v, read from Lyn, then k - 1
+// times r, then the ones of u, read from LynS. The last factor of v is a suffix of r, so it is larger than r,
+// and r is not smaller than the first factor of u, a prefix of r: the three factorizations are joined as they are.
+// The arrays can be saved in a binary encoding of O(n) bytes and read back, the factorizations are only built on
+// the queries.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "computeStructures.hpp"
+#include "duval.hpp"
+#include "leastRotation.hpp"
+using namespace std;
+
+// encoding of the numbers of a saved RotationFactorization
+enum class FactorizationEncoding : uint8_t
+{
+    Fixed32 = 4, // 4 bytes each, in the byte order of the machine
+    Fixed64 = 8, // 8 bytes each, in the byte order of the machine
+    Varint = 0   // 7 bits per byte, the high bit set on all bytes but the last
+};
+
+class RotationFactorization
+{
+public:
+    // empty, to be filled by read
+    RotationFactorization() = default;
+
+    // Lyn and LynS of the primitive root, computed without the suffix array. The word is not kept.
+    // Its chars are compared as unsigned bytes in every step, as in LongestLyndonDirect
+    RotationFactorization(const char *const word, const unsigned long length) : n(length)
+    {
+        if (n == 0)
+        {
+            return;
+        }
+        const uint8_t *const bytes = reinterpret_cast<const uint8_t *>(word);
+        rot = least_rotation_lyndon(bytes, n);
+        vector<char> root(n);
+        rotate_copy(word, word + rot, word + n, root.begin());
+        p = firstLyndonFactorLength(reinterpret_cast<const uint8_t *>(root.data()), n);
+        root.resize(p);
+
+        Lyn.resize(p);
+        LynS.resize(p);
+        LongestLyndonDirect(root.data(), p, Lyn.data());
+        LyndonSuffixTable(root.data(), p, LynS.data());
+    }
+
+    unsigned long length() const { return n; }
+
+    // the least rotation starts at this position of the word
+    unsigned long leastRotation() const { return rot; }
+
+    // length of the primitive root, the word is a power of it if it is less than length()
+    unsigned long period() const { return p; }
+
+    // factors gets the (offset, length) of each Lyndon factor of the rotation starting at position rotation of
+    // the word, offsets from the start of the rotation. Its memory is reused, so that queries do not allocate
+    void factorize(const unsigned long rotation, vector<pair<unsigned long, unsigned long>> &factors) const
+    {
+        factors.clear();
+        if (n == 0)
+        {
+            return;
+        }
+        const unsigned long q = (rotation + n - rot) % n % p;
+        unsigned long offset = 0;
+        const auto add = [&](const unsigned long factor_length) {
+            factors.emplace_back(offset, factor_length);
+            offset += factor_length;
+        };
+
+        // v, from Lyn
+        for (unsigned long j = q; q > 0 && j < p; j += Lyn[j])
+        {
+            add(Lyn[j]);
+        }
+        // the copies of r
+        for (unsigned long copy = q > 0 ? 1 : 0; copy < n / p; ++copy)
+        {
+            add(p);
+        }
+        // u, from LynS: the factors come from the last one and are reversed afterwards
+        const unsigned long first_of_u = factors.size();
+        for (unsigned long j = q; j > 0; j -= LynS[j - 1])
+        {
+            factors.emplace_back(0, LynS[j - 1]);
+        }
+        reverse(factors.begin() + first_of_u, factors.end());
+        for (unsigned long f = first_of_u; f < factors.size(); ++f)
+        {
+            factors[f].first = offset;
+            offset += factors[f].second;
+        }
+    }
+
+    vector<pair<unsigned long, unsigned long>> factorize(const unsigned long rotation) const
+    {
+        vector<pair<unsigned long, unsigned long>> factors;
+        factorize(rotation, factors);
+        return factors;
+    }
+
+    // "LYNR", the encoding byte, then n, the least rotation, the period, Lyn and LynS of the root. With Varint, LynS[j]
+    // is written as j + 1 - LynS[j], the start of the last factor of the prefix, which is 0 whenever the prefix is
+    // Lyndon: most numbers then take one byte. Fixed32 becomes Fixed64 when n does not fit in 32 bits
+    void write(ostream &out, FactorizationEncoding encoding) const
+    {
+        if (encoding == FactorizationEncoding::Fixed32 && n > numeric_limits<uint32_t>::max())
+        {
+            encoding = FactorizationEncoding::Fixed64;
+        }
+        vector<char> bytes(MAGIC, MAGIC + sizeof(MAGIC));
+        bytes.push_back(static_cast<char>(encoding));
+        const auto put = [&](const unsigned long value) {
+            if (encoding == FactorizationEncoding::Varint)
+            {
+                unsigned long rest = value;
+                for (; rest >= 0x80; rest >>= 7)
+                {
+                    bytes.push_back(static_cast<char>(rest | 0x80));
+                }
+                bytes.push_back(static_cast<char>(rest));
+            }
+            else if (encoding == FactorizationEncoding::Fixed32)
+            {
+                const uint32_t narrow = static_cast<uint32_t>(value);
+                bytes.insert(bytes.end(), reinterpret_cast<const char *>(&narrow), reinterpret_cast<const char *>(&narrow) + sizeof(narrow));
+            }
+            else
+            {
+                const uint64_t wide = value;
+                bytes.insert(bytes.end(), reinterpret_cast<const char *>(&wide), reinterpret_cast<const char *>(&wide) + sizeof(wide));
+            }
+        };
+
+        put(n);
+        put(rot);
+        put(p);
+        for (unsigned long j = 0; j < p; ++j)
+        {
+            put(Lyn[j]);
+        }
+        for (unsigned long j = 0; j < p; ++j)
+        {
+            put(encoding == FactorizationEncoding::Varint ? j + 1 - LynS[j] : LynS[j]);
+        }
+        out.write(bytes.data(), bytes.size());
+    }
+
+    // reads what write wrote, false and empty if the input is not a valid encoding
+    bool read(istream &in)
+    {
+        const vector<char> bytes{istreambuf_iterator<char>(in), istreambuf_iterator<char>()};
+        if (!decode(bytes))
+        {
+            *this = RotationFactorization();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr char MAGIC[4] = {'L', 'Y', 'N', 'R'};
+
+    bool decode(const vector<char> &bytes)
+    {
+        if (bytes.size() <= sizeof(MAGIC) || memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0)
+        {
+            return false;
+        }
+        const FactorizationEncoding encoding = static_cast<FactorizationEncoding>(bytes[sizeof(MAGIC)]);
+        if (encoding != FactorizationEncoding::Varint && encoding != FactorizationEncoding::Fixed32 && encoding != FactorizationEncoding::Fixed64)
+        {
+            return false;
+        }
+        unsigned long position = sizeof(MAGIC) + 1;
+        const auto get = [&](unsigned long &value) {
+            value = 0;
+            if (encoding == FactorizationEncoding::Varint)
+            {
+                // only the canonical encoding of a 64-bit number is accepted: the tenth byte holds a single bit,
+                // and the last byte is not 0 unless it is the only one
+                for (unsigned shift = 0; position < bytes.size() && shift < 64; shift += 7)
+                {
+                    const uint8_t byte = static_cast<uint8_t>(bytes[position++]);
+                    if (shift == 63 && (byte & 0xFE))
+                    {
+                        return false;
+                    }
+                    value |= static_cast<unsigned long>(byte & 0x7F) << shift;
+                    if (!(byte & 0x80))
+                    {
+                        return byte != 0 || shift == 0;
+                    }
+                }
+                return false;
+            }
+            const unsigned long width = static_cast<unsigned long>(encoding);
+            if (bytes.size() - position < width)
+            {
+                return false;
+            }
+            if (encoding == FactorizationEncoding::Fixed32)
+            {
+                uint32_t narrow;
+                memcpy(&narrow, bytes.data() + position, width);
+                value = narrow;
+            }
+            else
+            {
+                uint64_t wide;
+                memcpy(&wide, bytes.data() + position, width);
+                value = wide;
+            }
+            position += width;
+            return true;
+        };
+
+        // each number takes at least one byte, so a corrupted period cannot allocate more than the input
+        if (!get(n) || !get(rot) || !get(p) || p > n || (n > 0 && (p == 0 || n % p != 0 || rot >= n)) || p > (bytes.size() - position) / 2)
+        {
+            return false;
+        }
+        Lyn.resize(p);
+        LynS.resize(p);
+        for (unsigned long j = 0; j < p; ++j)
+        {
+            if (!get(Lyn[j]) || Lyn[j] == 0 || Lyn[j] > p - j)
+            {
+                return false;
+            }
+        }
+        for (unsigned long j = 0; j < p; ++j)
+        {
+            if (!get(LynS[j]))
+            {
+                return false;
+            }
+            if (encoding == FactorizationEncoding::Varint)
+            {
+                LynS[j] = j + 1 - LynS[j];
+            }
+            if (LynS[j] == 0 || LynS[j] > j + 1)
+            {
+                return false;
+            }
+        }
+        return position == bytes.size();
+    }
+
+    unsigned long n = 0;
+    unsigned long rot = 0;
+    unsigned long p = 0;
+    vector<unsigned long> Lyn; // of the primitive root
+    vector<unsigned long> LynS;
+};
+
+#endif
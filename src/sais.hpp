@@ -0,0 +1,275 @@
+#ifndef SAIS_HPP
+#define SAIS_HPP
+
+// Linear time suffix array construction by induced sorting (SA-IS), described in:
+// "Two Efficient Algorithms for Linear Time Suffix Array Construction" (Nong, Zhang, Chan)
+// unlike optimalSuffixArray, this uses explicit bucket arrays and O(n) extra words of memory,
+// in exchange for no binary searches and no shifts inside the buckets.
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <vector>
+using namespace std;
+
+// symbols of a text already renamed to [0, upper], as the reduced problems are
+template<typename IndexT>
+struct ArraySymbols
+{
+    const IndexT *text;
+    IndexT operator()(const IndexT i) const { return text[i]; }
+};
+
+// sym(i) returns the i-th symbol of the text, in [0, upper]
+// the empty suffix acts as a virtual sentinel, smaller than every symbol
+template<typename IndexT, typename SymbolFn>
+void sais_core(const SymbolFn &sym, IndexT *const SA, const IndexT length, const IndexT upper)
+{
+    constexpr IndexT EMPTY = numeric_limits<IndexT>::max();
+
+    if (length == 0)
+    {
+        return;
+    }
+    if (length == 1)
+    {
+        SA[0] = 0;
+        return;
+    }
+    if (length == 2)
+    {
+        if (sym(0) < sym(1))
+        {
+            SA[0] = 0;
+            SA[1] = 1;
+        }
+        else
+        {
+            SA[0] = 1;
+            SA[1] = 0;
+        }
+        return;
+    }
+
+    // isS[i] is true if suffix i is S-type, the last suffix is L-type because of the sentinel
+    vector<bool> isS(length, false);
+    for (IndexT i = length - 1; i > 0; --i)
+    {
+        const IndexT a = sym(i - 1);
+        const IndexT b = sym(i);
+        isS[i - 1] = (a == b) ? isS[i] : (a < b);
+    }
+
+    // bucketS[c] is the head of the S-suffixes of bucket c, bucketL[c] the head of bucket c
+    vector<IndexT> bucketL(upper + 2, 0);
+    vector<IndexT> bucketS(upper + 1, 0);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        if (!isS[i])
+        {
+            ++bucketS[sym(i)];
+        }
+        else
+        {
+            ++bucketL[sym(i) + 1];
+        }
+    }
+    for (IndexT c = 0; c <= upper; ++c)
+    {
+        bucketS[c] += bucketL[c];
+        bucketL[c + 1] += bucketS[c];
+    }
+
+    vector<IndexT> buffer(upper + 2);
+    const auto induce = [&](const vector<IndexT> &lms)
+    {
+        fill(SA, SA + length, EMPTY);
+
+        // LMS suffixes at the head of the S-type part of their buckets, in the given order
+        copy(bucketS.begin(), bucketS.end(), buffer.begin());
+        for (const IndexT d : lms)
+        {
+            SA[buffer[sym(d)]++] = d;
+        }
+
+        // L-type suffixes, left to right
+        copy(bucketL.begin(), bucketL.end(), buffer.begin());
+        SA[buffer[sym(length - 1)]++] = length - 1;
+        for (IndexT i = 0; i < length; ++i)
+        {
+            const IndexT v = SA[i];
+            if (v != EMPTY && v >= 1 && !isS[v - 1])
+            {
+                SA[buffer[sym(v - 1)]++] = v - 1;
+            }
+        }
+
+        // S-type suffixes, right to left
+        copy(bucketL.begin(), bucketL.end(), buffer.begin());
+        for (IndexT i = length; i > 0; --i)
+        {
+            const IndexT v = SA[i - 1];
+            if (v != EMPTY && v >= 1 && isS[v - 1])
+            {
+                SA[--buffer[sym(v - 1) + 1]] = v - 1;
+            }
+        }
+    };
+
+    // lmsIndex[i] is the position of i among the LMS suffixes, EMPTY if i is not LMS
+    vector<IndexT> lmsIndex(length + 1, EMPTY);
+    vector<IndexT> lms;
+    for (IndexT i = 1; i < length; ++i)
+    {
+        if (!isS[i - 1] && isS[i])
+        {
+            lmsIndex[i] = lms.size();
+            lms.push_back(i);
+        }
+    }
+    const IndexT m = lms.size();
+
+    // sort the LMS substrings
+    induce(lms);
+    if (m == 0)
+    {
+        return;
+    }
+
+    vector<IndexT> sortedLms;
+    sortedLms.reserve(m);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        if (lmsIndex[SA[i]] != EMPTY)
+        {
+            sortedLms.push_back(SA[i]);
+        }
+    }
+
+    // name the LMS substrings, the reduced string is stored in SA[length - m, length - 1]
+    // which does not overlap SA[0, m - 1] where the recursion writes, since m <= length / 2
+    IndexT * const reduced = SA + length - m;
+    IndexT name = 0;
+    reduced[lmsIndex[sortedLms[0]]] = 0;
+    for (IndexT i = 1; i < m; ++i)
+    {
+        IndexT l = sortedLms[i - 1];
+        IndexT r = sortedLms[i];
+        const IndexT endL = (lmsIndex[l] + 1 < m) ? lms[lmsIndex[l] + 1] : length;
+        const IndexT endR = (lmsIndex[r] + 1 < m) ? lms[lmsIndex[r] + 1] : length;
+        bool same = true;
+        if (endL - l != endR - r)
+        {
+            same = false;
+        }
+        else
+        {
+            while (l < endL && sym(l) == sym(r))
+            {
+                ++l;
+                ++r;
+            }
+            if (l == length || sym(l) != sym(r))
+            {
+                same = false;
+            }
+        }
+        if (!same)
+        {
+            ++name;
+        }
+        reduced[lmsIndex[sortedLms[i]]] = name;
+    }
+    lmsIndex = vector<IndexT>();
+
+    // recursion, only needed if some LMS substrings are equal
+    if (name + 1 < m)
+    {
+        sais_core(ArraySymbols<IndexT>{reduced}, SA, m, name);
+    }
+    else
+    {
+        for (IndexT i = 0; i < m; ++i)
+        {
+            SA[reduced[i]] = i;
+        }
+    }
+    for (IndexT i = 0; i < m; ++i)
+    {
+        sortedLms[i] = lms[SA[i]];
+    }
+    induce(sortedLms);
+}
+
+// upper bound on the bytes allocated by sais besides SA, used to decide if it fits a memory budget
+template<typename CharT, typename IndexT>
+unsigned long saisWorkspaceBytes(const unsigned long length)
+{
+    // top level buckets, plus the copy of the text with a dense alphabet for wide symbols
+    unsigned long bytes = 0;
+    if (sizeof(CharT) == 1)
+    {
+        bytes += 3 * (numeric_limits<uint8_t>::max() + 2) * sizeof(IndexT);
+    }
+    else
+    {
+        bytes += length * (sizeof(CharT) + sizeof(IndexT)) + 3 * (length + 2) * sizeof(IndexT);
+    }
+
+    // each level: types, LMS positions (twice), LMS names and the buckets of the next level
+    for (unsigned long n = length; n > 1; n /= 2)
+    {
+        bytes += n / CHAR_BIT + 1 + (2 * n + 1) * sizeof(IndexT) + 3 * (n / 2 + 2) * sizeof(IndexT);
+    }
+    return bytes;
+}
+
+// calls body(sym, upper) with sym(i) returning the i-th symbol of input renamed to [0, upper], preserving their order
+template<typename CharT, typename IndexT, typename Body>
+void withSmallSymbols(const CharT *const input, const IndexT length, const Body &body)
+{
+    if (sizeof(CharT) == 1)
+    {
+        const auto bytes = reinterpret_cast<const uint8_t *>(input);
+        body([bytes](const IndexT i) { return static_cast<IndexT>(bytes[i]); }, static_cast<IndexT>(numeric_limits<uint8_t>::max()));
+        return;
+    }
+
+    // wide symbols: use them directly if their range is small, otherwise rename them by rank
+    const auto range = minmax_element(input, input + length);
+    const CharT lowest = *range.first;
+    if (static_cast<unsigned long>(*range.second - lowest) < length)
+    {
+        body([input, lowest](const IndexT i) { return static_cast<IndexT>(input[i] - lowest); }, static_cast<IndexT>(*range.second - lowest));
+        return;
+    }
+
+    vector<CharT> alphabet(input, input + length);
+    sort(alphabet.begin(), alphabet.end());
+    alphabet.erase(unique(alphabet.begin(), alphabet.end()), alphabet.end());
+    vector<IndexT> dense(length);
+    for (IndexT i = 0; i < length; ++i)
+    {
+        dense[i] = lower_bound(alphabet.begin(), alphabet.end(), input[i]) - alphabet.begin();
+    }
+    const IndexT upper = alphabet.size() - 1;
+    alphabet = vector<CharT>();
+    body(ArraySymbols<IndexT>{dense.data()}, upper);
+}
+
+template<typename CharT, typename IndexT>
+void sais(const CharT *const input, IndexT *const SA, const IndexT length)
+{
+    if (length == 0)
+    {
+        return;
+    }
+
+    withSmallSymbols(input, length, [SA, length](const auto &sym, const IndexT upper)
+    {
+        sais_core(sym, SA, length, upper);
+    });
+}
+
+#endif
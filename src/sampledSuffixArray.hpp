@@ -0,0 +1,145 @@
+#ifndef SAMPLED_SUFFIX_ARRAY_HPP
+#define SAMPLED_SUFFIX_ARRAY_HPP
+
+// Sampled suffix arrays, keeping about length / rate entries for locate-style queries.
+// SuffixArrayOrder keeps the rows multiple of rate, TextOrder keeps the suffixes starting at a multiple of rate
+// together with a bitvector of their rows. Both compact the full suffix array built in place.
+// sparseSuffixArray sorts only the suffixes starting at a multiple of rate, without the full suffix array.
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "suffixArrayEngine.hpp"
+using namespace std;
+
+enum class SamplingMode
+{
+    SuffixArrayOrder, // every rate-th row of the suffix array
+    TextOrder         // the suffixes starting at positions multiple of rate
+};
+
+template<typename IndexT>
+struct SampledSuffixArray
+{
+    IndexT rate = 1;
+    SamplingMode mode = SamplingMode::SuffixArrayOrder;
+    vector<IndexT> samples; // the kept entries, by increasing row
+    vector<uint64_t> rows; // TextOrder: bit i is set if row i is kept
+    vector<IndexT> before; // TextOrder: before[b] = number of rows kept in the blocks before b
+
+    bool isSampled(const IndexT row) const
+    {
+        return mode == SamplingMode::SuffixArrayOrder ? row % rate == 0 : (rows[row >> 6] >> (row & 63)) & 1;
+    }
+
+    // SA[row], only for sampled rows
+    IndexT operator[](const IndexT row) const
+    {
+        if (mode == SamplingMode::SuffixArrayOrder)
+        {
+            return samples[row / rate];
+        }
+        return samples[before[row >> 6] + __builtin_popcountll(rows[row >> 6] & ((1ULL << (row & 63)) - 1))];
+    }
+};
+
+// the full suffix array is built in the samples vector, which is then compacted and shrunk
+template<typename CharT, typename IndexT>
+SampledSuffixArray<IndexT> sampledSuffixArray(const CharT *const input, const IndexT length, const IndexT rate, const SamplingMode mode, const SuffixArrayOptions &options = SuffixArrayOptions())
+{
+    SampledSuffixArray<IndexT> sampled;
+    sampled.rate = rate;
+    sampled.mode = mode;
+    vector<IndexT> &SA = sampled.samples;
+    SA.resize(length);
+    computeSuffixArray(input, SA.data(), length, options);
+
+    IndexT kept = 0;
+    if (mode == SamplingMode::SuffixArrayOrder)
+    {
+        for (IndexT row = 0; row < length; row += rate)
+        {
+            SA[kept++] = SA[row];
+        }
+    }
+    else
+    {
+        sampled.rows.assign(length / 64 + 1, 0);
+        sampled.before.resize(sampled.rows.size());
+        for (IndexT row = 0; row < length; ++row)
+        {
+            if ((row & 63) == 0)
+            {
+                sampled.before[row >> 6] = kept;
+            }
+            if (SA[row] % rate == 0)
+            {
+                sampled.rows[row >> 6] |= 1ULL << (row & 63);
+                SA[kept++] = SA[row];
+            }
+        }
+        if ((length & 63) == 0)
+        {
+            sampled.before[length >> 6] = kept;
+        }
+    }
+    SA.resize(kept);
+    SA.shrink_to_fit();
+    return sampled;
+}
+
+// the suffixes starting at positions multiple of rate, in lexicographic order.
+// Their order is the order of the suffixes of the text of blocks of rate symbols, where a block is compared
+// lexicographically and the last, shorter block is smaller than the blocks it is a prefix of.
+// The blocks are named by rank, so the workspace is O(length / rate) words
+template<typename CharT, typename IndexT>
+vector<IndexT> sparseSuffixArray(const CharT *const input, const IndexT length, const IndexT rate, const SuffixArrayOptions &options = SuffixArrayOptions())
+{
+    const IndexT blocks = length / rate + (length % rate != 0);
+    vector<IndexT> sparse(blocks);
+    if (blocks == 0)
+    {
+        return sparse;
+    }
+
+    const auto block = [input, length, rate](const IndexT b)
+    {
+        const CharT *const first = input + b * rate;
+        return make_pair(first, input + min<IndexT>(length, b * rate + rate));
+    };
+    const auto smaller = [&block](const IndexT a, const IndexT b)
+    {
+        const auto x = block(a);
+        const auto y = block(b);
+        return lexicographical_compare(x.first, x.second, y.first, y.second, [](const CharT u, const CharT v)
+        {
+            return static_cast<make_unsigned_t<CharT>>(u) < static_cast<make_unsigned_t<CharT>>(v);
+        });
+    };
+    for (IndexT b = 0; b < blocks; ++b)
+    {
+        sparse[b] = b;
+    }
+    sort(sparse.begin(), sparse.end(), smaller);
+
+    vector<IndexT> names(blocks);
+    IndexT name = 0;
+    for (IndexT i = 0; i < blocks; ++i)
+    {
+        if (i > 0 && smaller(sparse[i - 1], sparse[i]))
+        {
+            ++name;
+        }
+        names[sparse[i]] = name;
+    }
+
+    computeSuffixArray(names.data(), sparse.data(), blocks, options);
+    for (IndexT i = 0; i < blocks; ++i)
+    {
+        sparse[i] *= rate;
+    }
+    return sparse;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef SUFFIX_ARRAY_ENGINE_HPP
+#define SUFFIX_ARRAY_ENGINE_HPP
+
+// selection between the available suffix array constructions
+#include "optimalSuffixArray.hpp"
+#include "sais.hpp"
+
+enum class SuffixArrayEngine
+{
+    InPlace, // optimalSuffixArray, O(1) workspace
+    SAIS     // sais, faster but needs O(n) workspace
+};
+
+struct SuffixArrayOptions
+{
+    SuffixArrayEngine engine = SuffixArrayEngine::InPlace;
+    unsigned long memory_budget = 0; // bytes of workspace allowed besides input and SA, 0 = unlimited
+    unsigned threads = 1; // used by the in-place engine
+    unsigned long scratch_budget = 0; // bytes the in-place engine may use to replace its O(n log n) steps, 0 = none
+    bool performance_mode = false; // in-place engine: faster variants of the steps that do not need extra memory
+};
+
+// builds the suffix array with the requested engine, falling back to the in-place one
+// when the workspace of the requested engine exceeds the memory budget.
+// returns the engine that was actually used
+template<typename CharT, typename IndexT>
+SuffixArrayEngine computeSuffixArray(const CharT *const input, IndexT *const SA, const IndexT length, const SuffixArrayOptions &options)
+{
+    if (options.engine == SuffixArrayEngine::SAIS)
+    {
+        if (options.memory_budget == 0 || saisWorkspaceBytes<CharT, IndexT>(length) <= options.memory_budget)
+        {
+            sais(input, SA, length);
+            return SuffixArrayEngine::SAIS;
+        }
+    }
+    SuffixArrayContext<IndexT> context;
+    context.threads = options.threads;
+    context.scratch_budget = options.scratch_budget;
+    context.performance_mode = options.performance_mode;
+    optimalSuffixArray(input, SA, length, context);
+    return SuffixArrayEngine::InPlace;
+}
+
+#endif
@@ -4,6 +4,9 @@
 #include <functional>
 #include <math.h>
 #include <chrono>
+#include <thread>
+#include <sstream>
+#include <random>
 #include "utils.hpp"
 #include "naiveSuffix.hpp"
 
@@ -17,7 +20,6 @@ char *generateRandomString(const unsigned long SIZE, const char MIN_ALPHABET, co
     const unsigned long ALPHABET_SIZE = MAX_ALPHABET - MIN_ALPHABET + 1;
     char *word = new char [SIZE+1];
 
-    srand(time(0));
     for (unsigned long i = 0; i < SIZE; ++i){
         word[i] = MIN_ALPHABET + rand() % ALPHABET_SIZE;
     }
@@ -25,6 +27,16 @@ char *generateRandomString(const unsigned long SIZE, const char MIN_ALPHABET, co
     return word;
 }
 
+// random bytes of ALPHABET_SIZE symbols spread over the whole range, from 0 to 0xFF, so that the symbols
+// of even small alphabets are both positive and negative as chars
+char *generateRandomBytes(const unsigned long SIZE, const unsigned long ALPHABET_SIZE) {
+    char *word = generateRandomString(SIZE, 0, static_cast<char>(ALPHABET_SIZE - 1));
+    for (unsigned long i = 0; i < SIZE; ++i) {
+        word[i] = static_cast<char>(ALPHABET_SIZE > 1 ? word[i] * 255 / (ALPHABET_SIZE - 1) : 0);
+    }
+    return word;
+}
+
 void testForEachWordOfLength(const unsigned long length, const function<void (char[], unsigned long)> func) {
     char *word = new char[length+1];
     for (unsigned long i = 0; i < length; ++i) {
@@ -88,13 +100,14 @@ void testRandomEdgeChars(const unsigned long SIZE){
     delete[] suffix_array_naive;
 }
 
+template<typename IndexT = unsigned long>
 void testOneRandom(const unsigned long SIZE){
     char *word = generateRandomString(SIZE, 'A', 'Z');
-    unsigned long *input_as_long = new unsigned long [SIZE];
-    char_to_ulong_array(word, input_as_long, SIZE);
+    IndexT *input_as_long = new IndexT [SIZE];
+    char_to_index_array(word, input_as_long, static_cast<IndexT>(SIZE));
     
-    unsigned long* SA_optimal = new unsigned long [SIZE];
-    optimalSuffixArray(input_as_long, SA_optimal, SIZE);
+    IndexT* SA_optimal = new IndexT [SIZE];
+    optimalSuffixArray(input_as_long, SA_optimal, static_cast<IndexT>(SIZE));
     unsigned long *SA_naive = buildSuffixArray(word, SIZE);
 
     // look for differences
@@ -116,6 +129,677 @@ void testOneRandom(const unsigned long SIZE){
 
 
 
+// checks the byte path of optimalSuffixArray on the whole byte range (except '\0', for strcmp)
+void testOneRandomBytes(const unsigned long SIZE){
+    char *word = new char [SIZE+1];
+    for (unsigned long i = 0; i < SIZE; ++i){
+        word[i] = static_cast<char>(1 + rand() % 255);
+    }
+    word[SIZE] = '\0';
+
+    uint32_t* SA_optimal = new uint32_t [SIZE];
+    optimalSuffixArray(word, SA_optimal, static_cast<uint32_t>(SIZE));
+    unsigned long *SA_naive = buildSuffixArray(word, SIZE);
+
+    for (unsigned long i = 0; i < SIZE; ++i) {
+        if (SA_optimal[i] != SA_naive[i]) {
+            cout << "ERROR for random bytes at " << i << " - SA_optimal was '" << SA_optimal[i] << "' while SA_naive was '" << SA_naive[i] << "'" << endl;
+            cin.get();
+            break;
+        }
+    }
+
+    delete[] SA_optimal;
+    delete[] SA_naive;
+    delete[] word;
+}
+
+template<typename T>
+bool aux_SameArrays(const T * const computed, const unsigned long * const expected, const unsigned long length, const char * const testName) {
+    for (unsigned long i = 0; i < length; ++i) {
+        if (computed[i] != expected[i]) {
+            cout << "ERROR in " << testName << " at " << i << " - computed '" << computed[i] << "' while expected '" << expected[i] << "'" << endl;
+            cin.get();
+            return false;
+        }
+    }
+    return true;
+}
+
+// checks both engines on 16 and 32-bit symbols, as read with --bytes-per-char 2 and 4, against sorting the suffixes directly
+template<typename SymbolT>
+void testOneRandomWide(const unsigned long SIZE, const SymbolT MAX_SYMBOL) {
+    vector<SymbolT> input(SIZE);
+    for (unsigned long i = 0; i < SIZE; ++i) {
+        input[i] = static_cast<SymbolT>((static_cast<unsigned long>(rand()) << 16 ^ rand()) % (static_cast<unsigned long>(MAX_SYMBOL) + 1));
+    }
+    vector<unsigned long> expected(SIZE);
+    for (unsigned long i = 0; i < SIZE; ++i) expected[i] = i;
+    sort(expected.begin(), expected.end(), [&](const unsigned long a, const unsigned long b) {
+        return lexicographical_compare(input.begin() + a, input.end(), input.begin() + b, input.end());
+    });
+
+    vector<uint32_t> SA(SIZE);
+    SuffixArrayOptions options;
+    computeSuffixArray(input.data(), SA.data(), static_cast<uint32_t>(SIZE), options);
+    aux_SameArrays(SA.data(), expected.data(), SIZE, "optimalSuffixArray (wide symbols)");
+    options.engine = SuffixArrayEngine::SAIS;
+    computeSuffixArray(input.data(), SA.data(), static_cast<uint32_t>(SIZE), options);
+    aux_SameArrays(SA.data(), expected.data(), SIZE, "sais (wide symbols)");
+}
+
+// checks the two sampled suffix arrays and the sparse one against the full suffix array
+void testOneRandomSampledSA(const unsigned long SIZE, const uint32_t RATE, const char MAX_ALPHABET_CHAR, const SuffixArrayEngine engine) {
+    const char * const word = generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    SuffixArrayOptions options;
+    options.engine = engine;
+    vector<uint32_t> SA(SIZE);
+    computeSuffixArray(word, SA.data(), static_cast<uint32_t>(SIZE), options);
+
+    const SampledSuffixArray<uint32_t> by_row = sampledSuffixArray(word, static_cast<uint32_t>(SIZE), RATE, SamplingMode::SuffixArrayOrder, options);
+    const SampledSuffixArray<uint32_t> by_position = sampledSuffixArray(word, static_cast<uint32_t>(SIZE), RATE, SamplingMode::TextOrder, options);
+    vector<uint32_t> expected_sparse;
+    for (uint32_t row = 0; row < SIZE; ++row) {
+        const bool sampled_position = SA[row] % RATE == 0;
+        if (by_row.isSampled(row) != (row % RATE == 0) || (by_row.isSampled(row) && by_row[row] != SA[row])
+            || by_position.isSampled(row) != sampled_position || (sampled_position && by_position[row] != SA[row])) {
+            cout << "ERROR in sampledSuffixArray for the word " << word << " with rate " << RATE << " at row " << row << endl;
+            cin.get();
+            break;
+        }
+        if (sampled_position) expected_sparse.push_back(SA[row]);
+    }
+    if (by_row.samples.size() != (SIZE + RATE - 1) / RATE || by_position.samples.size() != expected_sparse.size()) {
+        cout << "ERROR in sampledSuffixArray for the word " << word << " with rate " << RATE << " - wrong number of samples" << endl;
+        cin.get();
+    }
+
+    const vector<uint32_t> sparse = sparseSuffixArray(word, static_cast<uint32_t>(SIZE), RATE, options);
+    if (sparse != expected_sparse) {
+        cout << "ERROR in sparseSuffixArray for the word " << word << " with rate " << RATE << endl;
+        cin.get();
+    }
+    delete[] word;
+}
+
+// checks sais against the naive construction on bytes and on wide symbols, both with a small and a sparse alphabet
+void testOneRandomSAIS(const unsigned long SIZE) {
+    static const unsigned long ul_alphabet[] = {0, LONG_MAX, ULONG_MAX-2, ULONG_MAX-1, ULONG_MAX};
+    const char * const word = generateRandomString(SIZE, 'A', 'E');
+    const unsigned long * const SA_naive = buildSuffixArray(word, SIZE);
+
+    uint32_t * const SA = new uint32_t[SIZE];
+    sais(word, SA, static_cast<uint32_t>(SIZE));
+    aux_SameArrays(SA, SA_naive, SIZE, "sais (bytes)");
+
+    unsigned long * const input_as_long = new unsigned long[SIZE];
+    char_to_ulong_array(word, input_as_long, SIZE);
+    sais(input_as_long, SA, static_cast<uint32_t>(SIZE));
+    aux_SameArrays(SA, SA_naive, SIZE, "sais (small alphabet)");
+
+    for (unsigned long i = 0; i < SIZE; ++i) {
+        input_as_long[i] = ul_alphabet[word[i] - 'A'];
+    }
+    sais(input_as_long, SA, static_cast<uint32_t>(SIZE));
+    aux_SameArrays(SA, SA_naive, SIZE, "sais (sparse alphabet)");
+
+    delete[] word;
+    delete[] SA_naive;
+    delete[] SA;
+    delete[] input_as_long;
+}
+
+// builds suffix arrays of independent words on concurrent threads, each with its own context
+void testConcurrentSuffixArrays(const unsigned long THREADS, const unsigned long SIZE) {
+    vector<char*> words(THREADS);
+    vector<uint32_t*> SAs(THREADS);
+    vector<SuffixArrayContext<uint32_t>> contexts(THREADS);
+    for (unsigned long t = 0; t < THREADS; ++t) {
+        words[t] = generateRandomString(SIZE + t, 'A', 'A' + t % 26);
+        SAs[t] = new uint32_t[SIZE + t];
+    }
+
+    vector<thread> threads;
+    for (unsigned long t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t]() { optimalSuffixArray(words[t], SAs[t], static_cast<uint32_t>(SIZE + t), contexts[t]); });
+    }
+    for (thread &th : threads) {
+        th.join();
+    }
+
+    for (unsigned long t = 0; t < THREADS; ++t) {
+        const unsigned long * const SA_naive = buildSuffixArray(words[t], SIZE + t);
+        aux_SameArrays(SAs[t], SA_naive, SIZE + t, "testConcurrentSuffixArrays");
+        delete[] SA_naive;
+        delete[] SAs[t];
+        delete[] words[t];
+    }
+}
+
+// with a scratch budget every level of a byte or 16-bit input of at least two symbols gets a bucket index,
+// so step 6 runs preprocess_buckets instead of the merge sort. Without a budget the index is never built
+template<typename SymbolT>
+void testOneRandomBucketIndex(const unsigned long SIZE, const unsigned long ALPHABET_SIZE) {
+    vector<SymbolT> input(SIZE);
+    const unsigned long spread = numeric_limits<SymbolT>::max() / max(1UL, ALPHABET_SIZE - 1);
+    for (SymbolT &symbol : input) symbol = static_cast<SymbolT>(rand() % ALPHABET_SIZE * spread);
+
+    vector<unsigned long> expected(SIZE);
+    for (unsigned long i = 0; i < SIZE; ++i) expected[i] = i;
+    sort(expected.begin(), expected.end(), [&](const unsigned long a, const unsigned long b) {
+        return lexicographical_compare(input.begin() + a, input.end(), input.begin() + b, input.end());
+    });
+
+    for (const unsigned long budget : {0UL, 16UL << 20}) {
+        SuffixArrayContext<uint32_t> context;
+        context.scratch_budget = budget;
+        vector<uint32_t> SA(SIZE);
+        optimalSuffixArray(input.data(), SA.data(), static_cast<uint32_t>(SIZE), context);
+        aux_SameArrays(SA.data(), expected.data(), SIZE, "testOneRandomBucketIndex");
+        if (context.bucket_heads.empty() != (budget == 0)) {
+            cout << "ERROR in testOneRandomBucketIndex: the bucket index is " << (budget ? "missing" : "built") << " with a scratch budget of " << budget << " for " << SIZE << " symbols of " << ALPHABET_SIZE << endl;
+            cin.get();
+        }
+    }
+}
+
+// checks optimalSuffixArray with the options of the context (threads, scratch budget...)
+void testOneRandomWithContext(const unsigned long SIZE, SuffixArrayContext<uint32_t> &context, const char MAX_ALPHABET_CHAR = 'Z') {
+    const char * const word = generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    uint32_t * const SA = new uint32_t[SIZE];
+    optimalSuffixArray(word, SA, static_cast<uint32_t>(SIZE), context);
+
+    const unsigned long * const SA_naive = buildSuffixArray(word, SIZE);
+    aux_SameArrays(SA, SA_naive, SIZE, "testOneRandomWithContext");
+
+    // same options for the recursive version
+    SuffixArrayContext<uint32_t> recursive_context;
+    recursive_context.threads = context.threads;
+    recursive_context.scratch_budget = context.scratch_budget;
+    recursive_context.performance_mode = context.performance_mode;
+    optimalSuffixArray_recursive(reinterpret_cast<const uint8_t*>(word), SA, static_cast<uint32_t>(SIZE), recursive_context);
+    aux_SameArrays(SA, SA_naive, SIZE, "testOneRandomWithContext (recursive)");
+
+    delete[] word;
+    delete[] SA;
+    delete[] SA_naive;
+}
+
+// checks both LCP constructions against a direct comparison of adjacent suffixes
+void testOneRandomLCP(const unsigned long SIZE, const char MAX_ALPHABET_CHAR, const unsigned threads) {
+    const char * const word = generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    const unsigned long * const SA_naive = buildSuffixArray(word, SIZE);
+    unsigned long * const LCP_naive = new unsigned long[SIZE];
+    LCP_naive[0] = 0;
+    for (unsigned long i = 1; i < SIZE; ++i) {
+        unsigned long h = 0;
+        while (SA_naive[i - 1] + h < SIZE && SA_naive[i] + h < SIZE && word[SA_naive[i - 1] + h] == word[SA_naive[i] + h]) {
+            ++h;
+        }
+        LCP_naive[i] = h;
+    }
+
+    uint32_t * const SA = new uint32_t[SIZE];
+    uint32_t * const LCP = new uint32_t[SIZE];
+    copy(SA_naive, SA_naive + SIZE, SA);
+    lcpArray(word, SA, static_cast<uint32_t>(SIZE), LCP, threads);
+    aux_SameArrays(LCP, LCP_naive, SIZE, "lcpArray");
+
+    fill(LCP, LCP + SIZE, 0);
+    lcpArray_inPlace(word, SA, static_cast<uint32_t>(SIZE), LCP);
+    aux_SameArrays(LCP, LCP_naive, SIZE, "lcpArray_inPlace");
+    aux_SameArrays(SA, SA_naive, SIZE, "lcpArray_inPlace (suffix array restored)");
+
+    delete[] word;
+    delete[] SA_naive;
+    delete[] LCP_naive;
+    delete[] SA;
+    delete[] LCP;
+}
+
+// checks the BWT against the last column of the sorted rotations of word$, and the streamed version against the array one
+void testOneRandomBWT(const unsigned long SIZE, const char MAX_ALPHABET_CHAR) {
+    const char * const word = generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    uint32_t * const SA = new uint32_t[SIZE];
+    optimalSuffixArray(word, SA, static_cast<uint32_t>(SIZE));
+    char * const transformed = new char[SIZE];
+    const uint32_t primary = bwtFromSA(word, SA, static_cast<uint32_t>(SIZE), transformed);
+
+    // the rotations are only sorted naively for short words
+    if (SIZE <= 1000) {
+        string terminated(word, SIZE);
+        terminated.push_back('\0'); // smaller than every symbol of the word
+        vector<string> rotations;
+        for (unsigned long i = 0; i <= SIZE; ++i) {
+            rotations.push_back(terminated.substr(i) + terminated.substr(0, i));
+        }
+        sort(rotations.begin(), rotations.end());
+        string expected;
+        unsigned long expected_primary = 0;
+        for (unsigned long i = 0; i <= SIZE; ++i) {
+            if (rotations[i].back() == '\0') {
+                expected_primary = i;
+            } else {
+                expected.push_back(rotations[i].back());
+            }
+        }
+        if (primary != expected_primary || string(transformed, SIZE) != expected) {
+            cout << "ERROR in bwtFromSA for the word " << word << " - computed " << string(transformed, SIZE) << " (" << primary << ") while expected " << expected << " (" << expected_primary << ")" << endl;
+            cin.get();
+        }
+    }
+
+    // wide symbols, written with 2 bytes each
+    unsigned long * const input_as_long = new unsigned long[SIZE];
+    char_to_ulong_array(word, input_as_long, SIZE);
+    ostringstream out;
+    const uint32_t streamed_primary = writeBWT(input_as_long, SA, static_cast<uint32_t>(SIZE), out, 2);
+    const string streamed = out.str();
+    bool same = streamed_primary == primary && streamed.size() == 2 * SIZE;
+    for (unsigned long i = 0; same && i < SIZE; ++i) {
+        same = streamed[2 * i] == transformed[i] && streamed[2 * i + 1] == 0;
+    }
+    if (!same) {
+        cout << "ERROR in writeBWT for the word " << word << endl;
+        cin.get();
+    }
+
+    // the file starts with the primary index
+    ostringstream file;
+    writeBWTFile(input_as_long, SA, static_cast<uint32_t>(SIZE), file, 2);
+    uint64_t header;
+    memcpy(&header, file.str().data(), sizeof(header));
+    if (header != primary || file.str().substr(sizeof(header)) != streamed) {
+        cout << "ERROR in writeBWTFile for the word " << word << endl;
+        cin.get();
+    }
+
+    delete[] word;
+    delete[] SA;
+    delete[] transformed;
+    delete[] input_as_long;
+}
+
+// checks the omega-order of the conjugates of a multiset of words against sorting their repetitions naively,
+// with the Lyndon factors of the word (the BBWT) or with random words. Strings compare chars as unsigned bytes,
+// as the BBWT does
+void testOneRandomConjugates(const unsigned long SIZE, const char MAX_ALPHABET_CHAR, const bool lyndon_factors, const bool whole_byte_range = false) {
+    const char * const word = whole_byte_range ? generateRandomBytes(SIZE, MAX_ALPHABET_CHAR - 'A' + 1) : generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    vector<uint32_t> starts{0};
+    if (lyndon_factors) {
+        starts = duvalBoundaries(reinterpret_cast<const uint8_t*>(word), static_cast<uint32_t>(SIZE));
+    } else {
+        for (unsigned long i = 1; i < SIZE; ++i) {
+            if (rand() % 4 == 0) starts.push_back(i);
+        }
+        starts.push_back(SIZE);
+    }
+
+    // equal omega-words have the same last symbol, so comparing long enough repetitions is enough
+    vector<pair<string, char>> conjugates;
+    for (unsigned long w = 0; w + 1 < starts.size(); ++w) {
+        const string factor(word + starts[w], starts[w + 1] - starts[w]);
+        for (unsigned long p = 0; p < factor.size(); ++p) {
+            const string conjugate = factor.substr(p) + factor.substr(0, p);
+            string repeated;
+            while (repeated.size() < 2 * SIZE) repeated += conjugate;
+            conjugates.push_back({repeated, conjugate.back()});
+        }
+    }
+    sort(conjugates.begin(), conjugates.end());
+    string expected;
+    for (const auto &conjugate : conjugates) expected.push_back(conjugate.second);
+
+    uint32_t * const SA = new uint32_t[SIZE];
+    string computed(SIZE, ' ');
+    if (lyndon_factors) {
+        bbwt(word, SA, static_cast<uint32_t>(SIZE), &computed[0]);
+    } else {
+        sortConjugates(word, starts.data(), static_cast<uint32_t>(starts.size() - 1), SA, static_cast<uint32_t>(SIZE));
+        const CyclicWords<uint32_t> cycles(starts.data(), starts.size() - 1, SIZE);
+        for (unsigned long i = 0; i < SIZE; ++i) computed[i] = word[cycles.prev(SA[i])];
+    }
+    if (computed != expected) {
+        cout << "ERROR in " << (lyndon_factors ? "bbwt" : "sortConjugates") << " for the word " << word << " - computed " << computed << " while expected " << expected << endl;
+        cin.get();
+    }
+
+    delete[] word;
+    delete[] SA;
+}
+
+// checks that unbbwt inverts bbwt, on a single thread and on multiple threads
+void testOneRandomUnBBWT(const unsigned long SIZE, const char MAX_ALPHABET_CHAR, const unsigned threads, const bool whole_byte_range = false) {
+    const char * const word = whole_byte_range ? generateRandomBytes(SIZE, MAX_ALPHABET_CHAR - 'A' + 1) : generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    uint32_t * const SA = new uint32_t[SIZE];
+    char * const transformed = new char[SIZE];
+    char * const decoded = new char[SIZE];
+    bbwt(word, SA, static_cast<uint32_t>(SIZE), transformed);
+
+    unbbwt(transformed, static_cast<uint32_t>(SIZE), decoded);
+    if (string(decoded, SIZE) != string(word, SIZE)) {
+        cout << "ERROR in unbbwt for the word " << word << " - decoded " << string(decoded, SIZE) << endl;
+        cin.get();
+    }
+    unbbwt(transformed, static_cast<uint32_t>(SIZE), decoded, threads);
+    if (string(decoded, SIZE) != string(word, SIZE)) {
+        cout << "ERROR in unbbwt with " << threads << " threads for the word " << word << " - decoded " << string(decoded, SIZE) << endl;
+        cin.get();
+    }
+
+    // wide symbols
+    unsigned long * const input_as_long = new unsigned long[SIZE];
+    unsigned long * const decoded_as_long = new unsigned long[SIZE];
+    for (unsigned long i = 0; i < SIZE; ++i) {
+        input_as_long[i] = static_cast<unsigned long>(static_cast<uint8_t>(transformed[i])) << 40;
+    }
+    unbbwt(input_as_long, static_cast<uint32_t>(SIZE), decoded_as_long, threads);
+    for (unsigned long i = 0; i < SIZE; ++i) {
+        if (decoded_as_long[i] != static_cast<unsigned long>(static_cast<uint8_t>(word[i])) << 40) {
+            cout << "ERROR in unbbwt (wide symbols) at " << i << endl;
+            cin.get();
+            break;
+        }
+    }
+
+    delete[] word;
+    delete[] SA;
+    delete[] transformed;
+    delete[] decoded;
+    delete[] input_as_long;
+    delete[] decoded_as_long;
+}
+
+// checks the eBWT of random words, some of them periodic, against sorting the repetitions of all their conjugates naively
+void testOneRandomEBWT(const unsigned long WORDS, const unsigned long MAX_WORD_LENGTH, const char MAX_ALPHABET_CHAR) {
+    string text;
+    vector<uint32_t> starts{0};
+    for (unsigned long w = 0; w < WORDS; ++w) {
+        const unsigned long root_length = 1 + rand() % MAX_WORD_LENGTH;
+        const char * const root = generateRandomString(root_length, 'A', MAX_ALPHABET_CHAR);
+        const unsigned long exponent = rand() % 4 == 0 ? 2 + rand() % 3 : 1;
+        for (unsigned long k = 0; k < exponent; ++k) text.append(root, root_length);
+        starts.push_back(text.size());
+        delete[] root;
+    }
+
+    vector<pair<string, char>> conjugates;
+    for (unsigned long w = 0; w < WORDS; ++w) {
+        const string word = text.substr(starts[w], starts[w + 1] - starts[w]);
+        for (unsigned long p = 0; p < word.size(); ++p) {
+            const string conjugate = word.substr(p) + word.substr(0, p);
+            string repeated;
+            while (repeated.size() < 2 * text.size()) repeated += conjugate;
+            conjugates.push_back({repeated, conjugate.back()});
+        }
+    }
+    sort(conjugates.begin(), conjugates.end());
+    string expected;
+    for (const auto &conjugate : conjugates) expected.push_back(conjugate.second);
+
+    uint32_t * const SA = new uint32_t[text.size()];
+    string computed(text.size(), ' ');
+    ebwt(text.c_str(), starts.data(), static_cast<uint32_t>(WORDS), SA, &computed[0]);
+    if (computed != expected) {
+        cout << "ERROR in ebwt for the words " << text << " - computed " << computed << " while expected " << expected << endl;
+        cin.get();
+    }
+    delete[] SA;
+}
+
+// checks the in-place and the cache-blocked rank arrays against the plain scatter, on a random permutation
+template<typename IndexT>
+void testOneRandomRankArray(const unsigned long SIZE, const unsigned threads) {
+    vector<IndexT> SA(SIZE);
+    for (unsigned long i = 0; i < SIZE; ++i) SA[i] = i;
+    shuffle(SA.begin(), SA.end(), mt19937(rand()));
+
+    vector<unsigned long> expected(SIZE);
+    for (unsigned long i = 0; i < SIZE; ++i) expected[SA[i]] = i;
+
+    vector<IndexT> rank(SIZE);
+    rankArrayFromSA(SA.data(), static_cast<IndexT>(SIZE), rank.data(), threads);
+    aux_SameArrays(rank.data(), expected.data(), SIZE, "rankArrayFromSA (blocked)");
+
+    rankArrayFromSA_inPlace(SA.data(), static_cast<IndexT>(SIZE));
+    aux_SameArrays(SA.data(), expected.data(), SIZE, "rankArrayFromSA_inPlace");
+}
+
+// checks the conjugate array against sorting the rotations naively, with periodic words and with both engines
+void testOneRandomConjugateArray(const unsigned long ROOT_SIZE, const unsigned long REPETITIONS, const char MAX_ALPHABET_CHAR, const SuffixArrayEngine engine) {
+    const char * const root = generateRandomString(ROOT_SIZE, 'A', MAX_ALPHABET_CHAR);
+    string word;
+    for (unsigned long k = 0; k < REPETITIONS; ++k) word.append(root, ROOT_SIZE);
+    const unsigned long SIZE = word.size();
+
+    vector<unsigned long> expected(SIZE);
+    for (unsigned long i = 0; i < SIZE; ++i) expected[i] = i;
+    stable_sort(expected.begin(), expected.end(), [&](const unsigned long a, const unsigned long b) {
+        return word.substr(a) + word.substr(0, a) < word.substr(b) + word.substr(0, b);
+    });
+
+    SuffixArrayOptions options;
+    options.engine = engine;
+    uint32_t * const CA = new uint32_t[SIZE];
+    conjugateArray(word.c_str(), CA, static_cast<uint32_t>(SIZE), options);
+    aux_SameArrays(CA, expected.data(), SIZE, "conjugateArray");
+
+    delete[] root;
+    delete[] CA;
+}
+
+// random documents, some of them empty, over bytes in [0, MAX_BYTE]: byte 0 must not act as a separator
+void testOneRandomGeneralizedSA(const unsigned long DOCUMENTS, const unsigned long MAX_DOCUMENT_LENGTH, const unsigned MAX_BYTE, const SuffixArrayEngine engine) {
+    vector<uint8_t> text;
+    vector<uint32_t> starts{0};
+    for (unsigned long d = 0; d < DOCUMENTS; ++d) {
+        const unsigned long document_length = rand() % (MAX_DOCUMENT_LENGTH + 1);
+        for (unsigned long i = 0; i < document_length; ++i) text.push_back(rand() % (MAX_BYTE + 1));
+        starts.push_back(text.size());
+    }
+
+    // suffixes as (document, offset), a suffix is smaller than its extensions and equal suffixes are ordered by document
+    vector<pair<uint32_t, uint32_t>> expected;
+    for (uint32_t d = 0; d < DOCUMENTS; ++d) {
+        for (uint32_t i = starts[d]; i < starts[d + 1]; ++i) expected.push_back({d, i});
+    }
+    stable_sort(expected.begin(), expected.end(), [&](const pair<uint32_t, uint32_t> &a, const pair<uint32_t, uint32_t> &b) {
+        return lexicographical_compare(text.begin() + a.second, text.begin() + starts[a.first + 1], text.begin() + b.second, text.begin() + starts[b.first + 1]);
+    });
+
+    SuffixArrayOptions options;
+    options.engine = engine;
+    uint32_t * const SA = new uint32_t[text.size() + DOCUMENTS];
+    generalizedSuffixArray(text.data(), starts.data(), static_cast<uint32_t>(DOCUMENTS), SA, options);
+    for (unsigned long i = 0; i < expected.size(); ++i) {
+        if (SA[i] != expected[i].second || documentOf(starts.data(), static_cast<uint32_t>(DOCUMENTS), SA[i]) != expected[i].first) {
+            cout << "ERROR in generalizedSuffixArray with " << DOCUMENTS << " documents at " << i << " - computed " << SA[i] << " while expected " << expected[i].second << endl;
+            cin.get();
+            break;
+        }
+    }
+    delete[] SA;
+}
+
+// checks the Lyndon array computed from the word alone against the one computed from the rank array
+void testOneLyndonArray(const string& word) {
+    const unsigned long SIZE = word.size();
+    unsigned long * const rank = new unsigned long[SIZE];
+    optimalSuffixArray(word.c_str(), rank, SIZE);
+    rankArrayFromSA_inPlace(rank, SIZE);
+    unsigned long * const expected = new unsigned long[SIZE];
+    LongestLyndon(word.c_str(), SIZE, rank, expected);
+
+    unsigned long * const Lyn = new unsigned long[SIZE];
+    LongestLyndonDirect(word.c_str(), SIZE, Lyn);
+    aux_SameArrays(Lyn, expected, SIZE, "LongestLyndonDirect");
+
+    delete[] rank;
+    delete[] expected;
+    delete[] Lyn;
+}
+
+// random words, and very repetitive ones: Fibonacci, Thue-Morse, powers of a random word
+void testOneRandomLyndonArray(const unsigned long SIZE, const char MAX_ALPHABET_CHAR) {
+    const char * const word = generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    testOneLyndonArray(word);
+
+    string fibonacci = "b", next = "ba";
+    while (next.size() < SIZE) {
+        fibonacci = next + fibonacci;
+        swap(fibonacci, next);
+    }
+    testOneLyndonArray(next.substr(0, SIZE));
+
+    string thue_morse;
+    for (unsigned long i = 0; i < SIZE; ++i) thue_morse.push_back('a' + __builtin_popcountl(i) % 2);
+    testOneLyndonArray(thue_morse);
+
+    string power;
+    while (power.size() < SIZE) power.append(word, 0, 1 + SIZE / 7);
+    power.resize(SIZE);
+    power.back() = MAX_ALPHABET_CHAR + rand() % 2;
+    testOneLyndonArray(power);
+    delete[] word;
+}
+
+// checks the views, the boundaries and the length of the first factor against the factors copied by duval
+void testOneRandomDuvalViews(const unsigned long SIZE, const char MAX_ALPHABET_CHAR) {
+    const char * const root = generateRandomString(1 + rand() % SIZE, 'A', MAX_ALPHABET_CHAR);
+    string word;
+    while (word.size() < SIZE) word += root;
+    word.resize(SIZE);
+
+    const vector<string> expected = duval(word);
+    const vector<string_view> views = duvalViews(word);
+    const vector<uint32_t> boundaries = duvalBoundaries(word.c_str(), static_cast<uint32_t>(SIZE));
+    bool same = views.size() == expected.size() && boundaries.size() == expected.size() + 1
+        && firstLyndonFactorLength(word.c_str(), SIZE) == expected[0].size();
+    for (unsigned long f = 0; same && f < expected.size(); ++f) {
+        same = views[f] == expected[f] && views[f].data() == word.c_str() + boundaries[f];
+    }
+    if (!same) {
+        cout << "ERROR in duvalViews for the word " << word << endl;
+        cin.get();
+    }
+    delete[] root;
+}
+
+// checks the multithreaded Lyndon factorization against the sequential one, on random words and on words
+// where the factors cross many chunks: powers of a random word, and non-increasing runs of symbols
+void testOneRandomParallelDuval(const unsigned long SIZE, const char MAX_ALPHABET_CHAR, const unsigned threads) {
+    const char * const random_word = generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    string power;
+    while (power.size() < SIZE) power.append(random_word, 0, 1 + rand() % (1 + SIZE / 3));
+    power.resize(SIZE);
+    string runs;
+    while (runs.size() < SIZE) runs.append(1 + rand() % (1 + SIZE / 5), MAX_ALPHABET_CHAR - rand() % 3);
+
+    for (const string &word : {string(random_word, SIZE), power, runs}) {
+        const vector<uint32_t> expected = duvalBoundaries(word.c_str(), static_cast<uint32_t>(SIZE));
+        const vector<uint32_t> computed = duvalBoundaries(word.c_str(), static_cast<uint32_t>(SIZE), threads);
+        if (computed != expected) {
+            cout << "ERROR in duvalBoundaries with " << threads << " threads for the word " << word << endl;
+            cin.get();
+        }
+    }
+    delete[] random_word;
+}
+
+// checks the factorization of every rotation against Duval on the rotation, on random words and on powers.
+// Chars are compared as unsigned bytes
+void testOneRandomRotationFactorization(const unsigned long SIZE, const char MAX_ALPHABET_CHAR, const bool whole_byte_range = false) {
+    const char * const random_word = whole_byte_range ? generateRandomBytes(SIZE, MAX_ALPHABET_CHAR - 'A' + 1) : generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    string power;
+    const unsigned long period = 1 + rand() % SIZE;
+    while (power.size() < SIZE * period) power.append(random_word, period);
+
+    vector<pair<unsigned long, unsigned long>> factors;
+    for (const string &word : {string(random_word, SIZE), power}) {
+        const RotationFactorization rotations(word.c_str(), word.size());
+        string rotation(word.size(), '\0');
+        for (unsigned long i = 0; i < word.size(); ++i) {
+            rotate_copy(word.begin(), word.begin() + i, word.end(), rotation.begin());
+            rotations.factorize(i, factors);
+            const vector<unsigned long> expected = duvalBoundaries(reinterpret_cast<const uint8_t*>(rotation.data()), rotation.size());
+            bool same = factors.size() + 1 == expected.size();
+            for (unsigned long f = 0; same && f < factors.size(); ++f) {
+                same = factors[f].first == expected[f] && factors[f].first + factors[f].second == expected[f + 1];
+            }
+            if (!same) {
+                cout << "ERROR in RotationFactorization for the rotation " << i << " of the word " << word << endl;
+                cin.get();
+            }
+        }
+    }
+    delete[] random_word;
+}
+
+// the factorizations read back from each encoding must be the computed ones, and a truncated encoding must be rejected
+void testOneRandomRotationFactorizationFile(const unsigned long SIZE, const char MAX_ALPHABET_CHAR, const bool whole_byte_range = false) {
+    const char * const random_word = whole_byte_range ? generateRandomBytes(SIZE, MAX_ALPHABET_CHAR - 'A' + 1) : generateRandomString(SIZE, 'A', MAX_ALPHABET_CHAR);
+    string power;
+    const unsigned long period = 1 + rand() % SIZE;
+    while (power.size() < SIZE * period) power.append(random_word, period);
+
+    for (const string &word : {string(random_word, SIZE), power}) {
+        const RotationFactorization computed(word.c_str(), word.size());
+        for (const FactorizationEncoding encoding : {FactorizationEncoding::Varint, FactorizationEncoding::Fixed32, FactorizationEncoding::Fixed64}) {
+            stringstream file;
+            computed.write(file, encoding);
+            const string bytes = file.str();
+
+            RotationFactorization loaded;
+            bool same = loaded.read(file) && loaded.length() == computed.length() && loaded.leastRotation() == computed.leastRotation();
+            for (unsigned long i = 0; same && i < word.size(); ++i) {
+                same = loaded.factorize(i) == computed.factorize(i);
+            }
+            istringstream truncated(bytes.substr(0, bytes.size() - 1));
+            if (!same || loaded.read(truncated) || loaded.length() != 0) {
+                cout << "ERROR in the encoding " << static_cast<int>(encoding) << " of RotationFactorization for the word " << word << endl;
+                cin.get();
+            }
+        }
+    }
+    delete[] random_word;
+}
+
+// read must reject truncated files and varints that are not the canonical encoding of a 64-bit number.
+// The file of "ab": n = 2, least rotation 0, period 2, Lyn = 2 1, LynS written as 0 0
+void testRotationFactorizationFileErrors() {
+    const string magic("LYNR\0", 5);
+    const string body("\x02\x00\x02\x02\x01\x00\x00", 7);
+    const auto reads = [](const string &bytes) {
+        istringstream file(bytes);
+        RotationFactorization loaded;
+        return loaded.read(file);
+    };
+
+    istringstream valid(magic + body);
+    RotationFactorization loaded;
+    const vector<pair<unsigned long, unsigned long>> expected{{0, 1}, {1, 1}};
+    if (!loaded.read(valid) || loaded.factorize(1) != expected) {
+        cout << "ERROR in RotationFactorization::read on a valid file" << endl;
+        cin.get();
+    }
+
+    const vector<pair<string, string>> invalid{
+        {"truncated", magic + body.substr(0, body.size() - 1)},
+        {"truncated inside a varint", magic + string("\x82", 1)},
+        {"overlong varint", magic + string("\x82\x00", 2) + body.substr(1)},
+        {"varint over 64 bits", magic + string("\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x02", 10) + body.substr(1)},
+        {"varint of 11 bytes", magic + string("\x80\x80\x80\x80\x80\x80\x80\x80\x80\x80\x00", 11) + body.substr(1)},
+        {"truncated fixed width", string("LYNR\x04", 5) + string(11, '\0')},
+        {"bad magic", "LYNX" + body}
+    };
+    for (const auto &file : invalid) {
+        if (reads(file.second)) {
+            cout << "ERROR in RotationFactorization::read, accepted a " << file.first << " file" << endl;
+            cin.get();
+        }
+    }
+}
+
 void testFactorsLyn(const char input_word[], const unsigned long word_length, const bool verbose=false) {
     char * const word = new char[word_length+1];
     const unsigned long least = least_rotation(input_word, word_length);
@@ -123,7 +807,7 @@ void testFactorsLyn(const char input_word[], const unsigned long word_length, co
     word[word_length] = '\0';
     
     // this test skips periodic words
-    if (duval(string(word)).size()!=1){
+    if (firstLyndonFactorLength(word, word_length) != word_length){
         aux_test_verbose("testFactorsLyn", input_word, "skipping test on periodic word", verbose);
         return;
     }
@@ -176,7 +860,7 @@ void testFactorsLynS(const char input_word[], const unsigned long word_length, c
     word[word_length] = '\0';
     
     // this test skips periodic words
-    if (duval(string(word)).size()!=1){
+    if (firstLyndonFactorLength(word, word_length) != word_length){
         aux_test_verbose("testFactorsLynS", input_word, "skipping test on periodic word", verbose);
         return;
     }
@@ -254,28 +938,38 @@ void testOptimalSuffixArray(const char input_word[], const unsigned long word_le
     delete[] input_as_long;
 }
 
+void testSAIS(const char input_word[], const unsigned long word_length) {
+    unsigned long *SA_sais = new unsigned long[word_length];
+    sais(input_word, SA_sais, word_length);
+    unsigned long *SA = buildSuffixArray(input_word, word_length);
+    aux_SameArrays(SA_sais, SA, word_length, "testSAIS");
+    delete[] SA;
+    delete[] SA_sais;
+}
+
 void testForSize(const unsigned long test_size) {
     testForEachWordOfLength(test_size, testFactorsLyn);
     testForEachWordOfLength(test_size, testFactorsLynS);
     testForEachWordOfLength(test_size, testOptimalSuffixArray);
+    testForEachWordOfLength(test_size, testSAIS);
 }
 
+template<typename IndexT = unsigned long>
 void loopRandomTests(const unsigned long TESTS, const unsigned long SIZE){
     cout << "Testing " << TESTS << " random strings of length " << SIZE << endl;
     for (unsigned long t = 0; t < TESTS; ++t){
-        testOneRandom(SIZE);
+        testOneRandom<IndexT>(SIZE);
     }
 }
 
-void executionTimeOptimalSuffixArray(const unsigned long SIZE, const unsigned long TESTS, const char MIN_ALPHABET_CHAR = 'A', const char MAX_ALPHABET_CHAR = 'Z'){
+void executionTimeOptimalSuffixArray(const unsigned long SIZE, const unsigned long TESTS, const char MIN_ALPHABET_CHAR = 'A', const char MAX_ALPHABET_CHAR = 'Z', const unsigned threads = 1, const unsigned long scratch_budget = 0, const bool performance_mode = false){
     const unsigned long MIN_ALPHABET = static_cast<unsigned long>(MIN_ALPHABET_CHAR);
     const unsigned long MAX_ALPHABET = static_cast<unsigned long>(MAX_ALPHABET_CHAR);
     const unsigned long ALPHABET_SIZE = MAX_ALPHABET - MIN_ALPHABET + 1;
-    cout << "Performance tests for Optimal Suffix Array on alphabet " << MIN_ALPHABET_CHAR << "-" << MAX_ALPHABET_CHAR << ":" << endl;
+    cout << "Performance tests for Optimal Suffix Array on alphabet " << MIN_ALPHABET_CHAR << "-" << MAX_ALPHABET_CHAR << " with " << threads << " thread(s), " << scratch_budget << " bytes of scratch" << (performance_mode ? " in performance mode" : "") << ":" << endl;
 
     unsigned long *input_as_long = new unsigned long [SIZE];
 
-    srand(time(0));
     for (unsigned long i = 0; i < SIZE; ++i){
         input_as_long[i] = MIN_ALPHABET + rand() % ALPHABET_SIZE;
     }
@@ -283,8 +977,12 @@ void executionTimeOptimalSuffixArray(const unsigned long SIZE, const unsigned lo
     unsigned long* SA_optimal = new unsigned long [SIZE];
 
     auto start = chrono::high_resolution_clock::now();
+    SuffixArrayContext<unsigned long> context;
+    context.threads = threads;
+    context.scratch_budget = scratch_budget;
+    context.performance_mode = performance_mode;
     for (unsigned long t = 0; t < TESTS; ++t){
-        optimalSuffixArray(input_as_long, SA_optimal, SIZE);
+        optimalSuffixArray(input_as_long, SA_optimal, SIZE, context);
     }
     auto end = chrono::high_resolution_clock::now();
     chrono::duration<double> elapsed = end - start;
@@ -294,12 +992,51 @@ void executionTimeOptimalSuffixArray(const unsigned long SIZE, const unsigned lo
     delete[] input_as_long;
 }
 
+void executionTimeBBWT(const unsigned long SIZE, const unsigned long TESTS, const char MIN_ALPHABET_CHAR = 'A', const char MAX_ALPHABET_CHAR = 'Z'){
+    cout << "Performance tests for the BBWT on alphabet " << MIN_ALPHABET_CHAR << "-" << MAX_ALPHABET_CHAR << ":" << endl;
+    const char * const word = generateRandomString(SIZE, MIN_ALPHABET_CHAR, MAX_ALPHABET_CHAR);
+    unsigned long* SA = new unsigned long [SIZE];
+    char* output = new char [SIZE];
+
+    auto start = chrono::high_resolution_clock::now();
+    for (unsigned long t = 0; t < TESTS; ++t){
+        bbwt(word, SA, SIZE, output);
+    }
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed = end - start;
+    cout << "BBWT for size " << SIZE << " over " << TESTS << " tests took " << elapsed.count() << " seconds." << endl;
+
+    delete[] SA;
+    delete[] output;
+    delete[] word;
+}
+
+void executionTimeSAIS(const unsigned long SIZE, const unsigned long TESTS, const char MIN_ALPHABET_CHAR = 'A', const char MAX_ALPHABET_CHAR = 'Z'){
+    cout << "Performance tests for SA-IS on alphabet " << MIN_ALPHABET_CHAR << "-" << MAX_ALPHABET_CHAR << ":" << endl;
+    const char * const word = generateRandomString(SIZE, MIN_ALPHABET_CHAR, MAX_ALPHABET_CHAR);
+    unsigned long* SA = new unsigned long [SIZE];
+
+    auto start = chrono::high_resolution_clock::now();
+    for (unsigned long t = 0; t < TESTS; ++t){
+        sais(word, SA, SIZE);
+    }
+    auto end = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed = end - start;
+    cout << "SA-IS for size " << SIZE << " over " << TESTS << " tests took " << elapsed.count() << " seconds." << endl;
+
+    delete[] SA;
+    delete[] word;
+}
+
 void testAll() {
     const unsigned long EXHAUSTIVE_LIMIT = 5;
     const unsigned long NUMBER_OF_TESTS_FOR_EDGE_CASES = 200;
     const unsigned long TEST_SIZE_FOR_EDGE_CASES = 100000;
     
     cout << "Running all tests..." << endl;
+
+    // seeded once: reseeding with the same second would repeat the same inputs in consecutive tests
+    srand(time(0));
     
     for (int size = 1; size <= EXHAUSTIVE_LIMIT; ++size) {
         cout << "Performing exhaustive test on all words of size " << size << endl;
@@ -312,14 +1049,187 @@ void testAll() {
     loopRandomTests(1000, 10000);
     loopRandomTests(100, 100000);
 
+    cout << endl << "Performing random tests for 32-bit suffix arrays..." << endl;
+    loopRandomTests<uint32_t>(10000, 101);
+    loopRandomTests<uint32_t>(100, 100000);
+
+    cout << endl << "Performing random tests on the whole byte alphabet..." << endl;
+    for (int i = 0; i < 100; ++i) {
+        testOneRandomBytes(10000);
+    }
+
+    cout << endl << "Performing random tests on 16 and 32-bit symbols..." << endl;
+    for (int i = 0; i < 100; ++i) {
+        testOneRandomWide<uint16_t>(1 + i * 100, i % 2 == 0 ? 3 : numeric_limits<uint16_t>::max());
+        testOneRandomWide<uint32_t>(1 + i * 100, i % 2 == 0 ? 3 : numeric_limits<uint32_t>::max());
+    }
+
+    cout << endl << "Performing concurrent suffix array constructions..." << endl;
+    testConcurrentSuffixArrays(16, 10000);
+
+    cout << endl << "Performing random tests for the multithreaded in-place suffix array construction..." << endl;
+    for (unsigned threads = 2; threads <= 8; ++threads) {
+        SuffixArrayContext<uint32_t> context;
+        context.threads = threads;
+        testOneRandomWithContext(1 + rand() % 1000, context, 'B');
+        testOneRandomWithContext(100000, context, 'B');
+        testOneRandomWithContext(100000, context, 'Z');
+    }
+
+    cout << endl << "Performing random tests for the in-place suffix array construction in performance mode..." << endl;
+    for (unsigned threads = 1; threads <= 4; ++threads) {
+        SuffixArrayContext<uint32_t> context;
+        context.threads = threads;
+        context.performance_mode = true;
+        for (unsigned long size = 1; size <= 100; ++size) {
+            testOneRandomWithContext(size, context, 'C');
+        }
+        testOneRandomWithContext(100000, context, 'B');
+        testOneRandomWithContext(100000, context, 'Z');
+    }
+
+    cout << endl << "Performing random tests for the in-place suffix array construction with scratch memory..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        SuffixArrayContext<uint32_t> context;
+        context.scratch_budget = ULONG_MAX;
+        testOneRandomWithContext(1 + i, context, 'A' + i % 26);
+    }
+    for (unsigned long budget = 0; budget <= 1000000; budget += 100000) {
+        SuffixArrayContext<uint32_t> context;
+        context.scratch_budget = budget; // only the levels that fit the budget use scratch memory
+        testOneRandomWithContext(100000, context, 'C');
+    }
+    for (unsigned long i = 0; i < 200; ++i) {
+        testOneRandomBucketIndex<uint8_t>(10 + i * 5, 2 + i % 255);
+        testOneRandomBucketIndex<uint16_t>(10 + i * 5, 2 + i * 37 % 4000);
+    }
+
+    cout << endl << "Performing random tests for SA-IS suffix array construction..." << endl;
+    for (int i = 0; i < 1000; ++i) {
+        testOneRandomSAIS(1 + i % 100);
+    }
+    for (int i = 0; i < 10; ++i) {
+        testOneRandomSAIS(100000);
+    }
+
+    cout << endl << "Performing random tests for LCP array construction..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomLCP(1 + i % 100, 'A' + i % 3, 1 + i % 4);
+    }
+    for (unsigned threads = 1; threads <= 8; ++threads) {
+        testOneRandomLCP(100000, 'B', threads);
+        testOneRandomLCP(100000, 'Z', threads);
+    }
+
+    cout << endl << "Performing random tests for the rank array..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomRankArray<uint32_t>(1 + i, 1 + i % 4);
+    }
+    for (unsigned threads = 1; threads <= 8; ++threads) {
+        testOneRandomRankArray<uint32_t>(1000000, threads);
+        testOneRandomRankArray<unsigned long>(1000000, threads);
+    }
+
+    cout << endl << "Performing random tests for the Lyndon factorization views..." << endl;
+    for (unsigned long i = 0; i < 2000; ++i) {
+        testOneRandomDuvalViews(1 + i % 100, 'A' + i % 4);
+    }
+
+    cout << endl << "Performing random tests for the multithreaded Lyndon factorization..." << endl;
+    for (unsigned long i = 0; i < 2000; ++i) {
+        testOneRandomParallelDuval(1 + i % 300, 'A' + i % 4, 2 + i % 15);
+    }
+    for (unsigned threads = 2; threads <= 8; ++threads) {
+        testOneRandomParallelDuval(1000000, 'C', threads);
+    }
+
+    cout << endl << "Performing random tests for the factorization of single rotations..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomRotationFactorization(1 + i % 60, 'A' + i % 4);
+        testOneRandomRotationFactorization(1 + i % 60, 'A' + i % 4, true);
+    }
+
+    for (unsigned long i = 0; i < 500; ++i) {
+        testOneRandomRotationFactorizationFile(1 + i % 60, 'A' + i % 4, i % 2 == 0);
+    }
+    testRotationFactorizationFileErrors();
+
+    cout << endl << "Performing random tests for the Lyndon array without the suffix array..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomLyndonArray(1 + i % 200, 'A' + i % 4);
+    }
+    testOneRandomLyndonArray(1000000, 'B');
+
+    cout << endl << "Performing random tests for the conjugate array..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomConjugateArray(1 + i % 50, 1 + i % 4, 'A' + i % 3, i % 2 == 0 ? SuffixArrayEngine::InPlace : SuffixArrayEngine::SAIS);
+    }
+
+    cout << endl << "Performing random tests for the sampled and sparse suffix arrays..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomSampledSA(1 + i % 200, 1 + i % 9, 'A' + i % 3, i % 2 == 0 ? SuffixArrayEngine::InPlace : SuffixArrayEngine::SAIS);
+    }
+    testOneRandomSampledSA(100000, 32, 'B', SuffixArrayEngine::InPlace);
+
+    cout << endl << "Performing random tests for the generalized suffix array..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomGeneralizedSA(1 + i % 12, i % 30, i % 3 == 0 ? 1 : 255, i % 2 == 0 ? SuffixArrayEngine::InPlace : SuffixArrayEngine::SAIS);
+    }
+    testOneRandomGeneralizedSA(70000, 3, 255, SuffixArrayEngine::InPlace); // 32-bit stored symbols
+    testOneRandomGeneralizedSA(70000, 3, 255, SuffixArrayEngine::SAIS);
+
+    cout << endl << "Performing random tests for the Burrows-Wheeler transform..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomBWT(1 + i % 100, 'A' + i % 4);
+    }
+    testOneRandomBWT(100000, 'Z'); // more than one block when streamed
+
+    cout << endl << "Performing random tests for the bijective Burrows-Wheeler transform..." << endl;
+    for (unsigned long i = 0; i < 2000; ++i) {
+        testOneRandomConjugates(1 + i % 200, 'A' + i % 3, i % 2 == 0);
+    }
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomUnBBWT(1 + i % 100, 'A' + i % 3, 2 + i % 7);
+    }
+    for (unsigned threads = 1; threads <= 8; ++threads) {
+        testOneRandomUnBBWT(100000, 'B', threads);
+        testOneRandomUnBBWT(100000, 'Z', threads);
+    }
+    // bytes from 0x80 are larger than the others
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomConjugates(1 + i % 200, 'A' + i % 3, i % 2 == 0, true);
+        testOneRandomUnBBWT(1 + i % 100, 'A' + i % 3, 2 + i % 7, true);
+    }
+    for (unsigned threads = 1; threads <= 8; ++threads) {
+        testOneRandomUnBBWT(100000, 'B', threads, true);
+        testOneRandomUnBBWT(100000, '~', threads, true);
+    }
+
+    cout << endl << "Performing random tests for the extended Burrows-Wheeler transform..." << endl;
+    for (unsigned long i = 0; i < 1000; ++i) {
+        testOneRandomEBWT(1 + i % 20, 1 + i % 10, 'A' + i % 3);
+    }
+
     cout << endl << "Performing " << NUMBER_OF_TESTS_FOR_EDGE_CASES << " tests on random strings with edge characters of length 100001..." << endl;
     for (int i = 0; i < NUMBER_OF_TESTS_FOR_EDGE_CASES; ++i) {
         testOneRandom(TEST_SIZE_FOR_EDGE_CASES);
     }
 
+    // symbols 0, LONG_MAX and the largest unsigned longs: too far apart for a bucket index, so the binary search is used
+    cout << endl << "Performing " << NUMBER_OF_TESTS_FOR_EDGE_CASES << " tests on random strings of extreme unsigned long symbols..." << endl;
+    for (int i = 0; i < NUMBER_OF_TESTS_FOR_EDGE_CASES; ++i) {
+        testRandomEdgeChars(TEST_SIZE_FOR_EDGE_CASES);
+    }
+
     cout << endl << "Performance tests for optimal suffix array construction" << endl;
     executionTimeOptimalSuffixArray(100000, 100, 'A', 'Z');
     executionTimeOptimalSuffixArray(100000, 100, 'A', 'B');
+    executionTimeOptimalSuffixArray(100000, 100, 'A', 'Z', resolveThreads(0));
+    executionTimeOptimalSuffixArray(100000, 100, 'A', 'Z', 1, ULONG_MAX);
+    executionTimeOptimalSuffixArray(100000, 100, 'A', 'Z', 1, 0, true);
+    executionTimeOptimalSuffixArray(100000, 100, 'A', 'Z', 1, ULONG_MAX, true);
+    executionTimeSAIS(100000, 100, 'A', 'Z');
+    executionTimeBBWT(100000, 100, 'A', 'Z');
 
     cout << "All tests completed." << endl;
 }
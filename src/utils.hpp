@@ -8,13 +8,22 @@
 #include <fstream>
 #include <algorithm>
 #include "tree.hpp"
-#include "optimalSuffixArray.hpp"
+#include "suffixArrayEngine.hpp"
+#include "lcp.hpp"
+#include "bwt.hpp"
+#include "bbwt.hpp"
+#include "ebwt.hpp"
+#include "conjugateArray.hpp"
+#include "generalizedSuffixArray.hpp"
+#include "sampledSuffixArray.hpp"
 #include "duval.hpp"
 #include "leastRotation.hpp"
 #include "computeStructures.hpp"
+#include "rotationFactorization.hpp"
 using namespace std;
 
-void aux_PrintArray(const unsigned long * const array, const unsigned long length)
+template<typename T>
+void aux_PrintArray(const T * const array, const unsigned long length)
 {
     for (unsigned long i = 0; i < length; ++i) {
         if (i) cout << ", ";
@@ -23,8 +32,9 @@ void aux_PrintArray(const unsigned long * const array, const unsigned long lengt
     cout << endl;
 }
 
-void aux_PrintArray(const unsigned long * const array, const unsigned long length, const string array_name) {
-    cout << array_name << ": ";
+template<typename T>
+void aux_PrintArray(const T * const array, const unsigned long length, const string array_name) {
+    if (!array_name.empty()) cout << array_name << ": ";
     aux_PrintArray(array, length);
 }
 
@@ -53,7 +63,13 @@ char* readFile(const string filename, const unsigned long max_size, unsigned lon
     return output_buffer;
 }
 
-unsigned long* readFile(const string filename, const unsigned long bytes_per_char, const unsigned long max_chars, unsigned long& size) {
+// number of symbols read at a time when they are narrower than the output type
+constexpr unsigned long READ_BLOCK_SYMBOLS = 1UL << 16;
+
+// reads the file as symbols of bytes_per_char bytes each (at most sizeof(SymbolT)), in the byte order of the machine.
+// When bytes_per_char is sizeof(SymbolT) the file is read directly into the output, without conversions
+template<typename SymbolT>
+SymbolT* readSymbols(const string filename, const unsigned long bytes_per_char, const unsigned long max_chars, unsigned long& size) {
 
     ifstream file(filename, ios::binary | ios::ate);
     if (!file) {
@@ -63,15 +79,92 @@ unsigned long* readFile(const string filename, const unsigned long bytes_per_cha
     size = file.tellg() / bytes_per_char;
     if (size > max_chars && max_chars > 0) size = max_chars;
     file.seekg(0, ios::beg);
-    unsigned long *output_buffer = new unsigned long[size * sizeof(unsigned long)];
-    for (unsigned long i = 0; i < size; ++i) {
-        unsigned long char_value = 0;
-        file.read(reinterpret_cast<char*>(&char_value), bytes_per_char);
-        output_buffer[i] = char_value;
+
+    SymbolT *output_buffer = new SymbolT[size];
+    if (bytes_per_char == sizeof(SymbolT)) {
+        if (!file.read(reinterpret_cast<char*>(output_buffer), size * sizeof(SymbolT))) {
+            cerr << "Failed to read file.\n";
+            delete[] output_buffer;
+            return nullptr;
+        }
+        return output_buffer;
+    }
+
+    // narrower symbols: read a block at a time and widen them
+    vector<char> block(READ_BLOCK_SYMBOLS * bytes_per_char);
+    for (unsigned long i = 0; i < size; i += READ_BLOCK_SYMBOLS) {
+        const unsigned long count = min(READ_BLOCK_SYMBOLS, size - i);
+        if (!file.read(block.data(), count * bytes_per_char)) {
+            cerr << "Failed to read file.\n";
+            delete[] output_buffer;
+            return nullptr;
+        }
+        for (unsigned long k = 0; k < count; ++k) {
+            SymbolT char_value = 0;
+            memcpy(&char_value, block.data() + k * bytes_per_char, bytes_per_char);
+            output_buffer[i + k] = char_value;
+        }
     }
     return output_buffer;
 }
 
+unsigned long* readFile(const string filename, const unsigned long bytes_per_char, const unsigned long max_chars, unsigned long& size) {
+    return readSymbols<unsigned long>(filename, bytes_per_char, max_chars, size);
+}
+
+// reads a file with one word per line: the words are returned one after the other, without the line breaks,
+// and starts gets the starting position of each word followed by the total length. Empty lines are skipped
+char* readWords(const string filename, vector<unsigned long>& starts) {
+    unsigned long size;
+    char* const content = readFile(filename, numeric_limits<unsigned long>::max(), size);
+    if (!content) {
+        return nullptr;
+    }
+
+    unsigned long length = 0;
+    starts.assign(1, 0);
+    for (unsigned long i = 0; i < size; ++i) {
+        if (content[i] == '\n' || content[i] == '\r') {
+            if (length != starts.back()) {
+                starts.push_back(length);
+            }
+        }
+        else {
+            content[length++] = content[i];
+        }
+    }
+    if (length != starts.back()) {
+        starts.push_back(length);
+    }
+    return content;
+}
+
+// reads the files one after the other into a single buffer: starts gets the starting position of each file
+// followed by the total length
+char* readDocuments(const vector<string>& filenames, vector<unsigned long>& starts) {
+    starts.assign(1, 0);
+    for (const string& filename : filenames) {
+        ifstream file(filename, ios::binary | ios::ate);
+        if (!file) {
+            cerr << "Failed to open file " << filename << ".\n";
+            return nullptr;
+        }
+        starts.push_back(starts.back() + static_cast<unsigned long>(file.tellg()));
+    }
+
+    char* const text = new char[starts.back() + 1];
+    for (unsigned long d = 0; d < filenames.size(); ++d) {
+        ifstream file(filenames[d], ios::binary);
+        if (!file || !file.read(text + starts[d], starts[d + 1] - starts[d])) {
+            cerr << "Failed to read file " << filenames[d] << ".\n";
+            delete[] text;
+            return nullptr;
+        }
+    }
+    text[starts.back()] = '\0';
+    return text;
+}
+
 string_view GetLastFactorOfPrefix(const char* const word, unsigned long prefix_length, const unsigned long* const LynS) {
     const unsigned long len = LynS[prefix_length-1];
     return string_view(word + prefix_length - len, len);
@@ -157,8 +250,8 @@ void PrintAllFactorsNaive(const char * const input_word, const unsigned long wor
         rotate_copy(input_word, input_word+i, input_word+word_length, rotation);
         rotation[word_length] = '\0';
         cout << "Factors of rotation " << rotation << ": ";
-        for (string s : duval(string(rotation))) {
-            cout << s << ", ";
+        for (const string_view factor : duvalViews(string_view(rotation, word_length))) {
+            cout << factor << ", ";
         }
         cout << endl;
     }
@@ -166,8 +259,9 @@ void PrintAllFactorsNaive(const char * const input_word, const unsigned long wor
 }
 
 
-// this function shows what we implemented, it is just a proof of concept
-void PrintAllFactors(const char * const input_word, const bool verbose) {
+// this function shows what we implemented, it is just a proof of concept.
+// With direct_lyn, Lyn is computed from the word alone and the suffix array is not built
+void PrintAllFactors(const char * const input_word, const bool verbose, const unsigned threads = 1, const bool direct_lyn = false) {
     // allocate memory
     const unsigned long word_length = strlen(input_word);
     char* word = new char[word_length+1];
@@ -181,20 +275,33 @@ void PrintAllFactors(const char * const input_word, const bool verbose) {
         cout << "Working on smallest conjugate at index " << rot << ": " << word << endl;
     }
 
-    // check if it's periodic
-    const vector<string> factors = duval(string(word));
-    if (factors.size() == 1) {
-        // compute suffix array
-        unsigned long * const SA = new unsigned long[word_length];
-        optimalSuffixArray(word, SA, word_length);
-
-        // rank array
-        unsigned long * const rank = new unsigned long[word_length];
-        rankArrayFromSA(SA, word_length, rank);
-
+    // check if it's periodic: the first Lyndon factor of the smallest rotation is its primitive root
+    const unsigned long root_length = firstLyndonFactorLength(word, word_length);
+    if (root_length == word_length) {
         // Lyndon Table
         unsigned long* const Lyn = new unsigned long[word_length];
-        LongestLyndon(word, word_length, rank, Lyn);
+        if (direct_lyn) {
+            LongestLyndonDirect(word, word_length, Lyn);
+        }
+        else {
+            // compute suffix array
+            unsigned long * const SA = new unsigned long[word_length];
+            optimalSuffixArray(word, SA, word_length);
+
+            // rank array: with a single thread it replaces the suffix array, which is not needed anymore
+            unsigned long * rank = SA;
+            if (threads > 1) {
+                rank = new unsigned long[word_length];
+                rankArrayFromSA(SA, word_length, rank, threads);
+            }
+            else {
+                rankArrayFromSA_inPlace(SA, word_length);
+            }
+
+            LongestLyndon(word, word_length, rank, Lyn);
+            if (rank != SA) delete[] rank;
+            delete[] SA;
+        }
 
         // Lyndon Suffix Table (LynS)
         unsigned long* const LynS = new unsigned long[word_length];
@@ -224,19 +331,16 @@ void PrintAllFactors(const char * const input_word, const bool verbose) {
             PrintSuffixesFactorsFromLyn(word, word_length, Lyn);
         }
 
-        delete[] SA;
         delete[] word;
-        delete[] rank;
         delete[] Lyn;
         delete[] LynS;
     }
     else {
-        if (verbose) cout << endl << word << " is periodic and its primitive root is: " << factors[0] << endl;
+        if (verbose) cout << endl << word << " is periodic and its primitive root is: " << string_view(word, root_length) << endl;
 
+        word[root_length] = '\0';
+        PrintAllFactors(word, verbose, threads, direct_lyn);
         delete[] word;
-
-        unsigned long first_factor_length = factors[0].length();
-        PrintAllFactors(factors[0].c_str(), verbose);
     }
 }
 